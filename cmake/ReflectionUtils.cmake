@@ -1,4 +1,16 @@
 option(REFLECTION_USE_PREBUILT_BINARY "" OFF)
+set(REFLECTION_GENERATOR_JOBS 1 CACHE STRING "Number of headers the reflection generator parses in parallel, 0 means all hardware threads")
+option(REFLECTION_GENERATOR_BATCH "Parse all reflection headers of a target in one translation unit per generator job" OFF)
+option(REFLECTION_GENERATOR_INCREMENTAL "Reuse reflection results of unchanged headers from the previous generator run" OFF)
+option(REFLECTION_GENERATOR_PRECOMPILED_PREAMBLE "Precompile the pre-include headers once and reuse them for every reflected header" OFF)
+set(REFLECTION_GENERATOR_PREAMBLE_HEADERS "string;vector;map;unordered_map;tuple;functional;memory" CACHE STRING "System headers added to the reflection generator precompiled preamble")
+set(REFLECTION_GENERATOR_EMITTER "inja" CACHE STRING "Code emitter backend of the reflection generator, inja or native")
+set_property(CACHE REFLECTION_GENERATOR_EMITTER PROPERTY STRINGS inja native)
+set(REFLECTION_GENERATOR_SHARDS 1 CACHE STRING "Number of type register sources generated per target, compiled in parallel")
+set(REFLECTION_GENERATOR_SERVER "" CACHE STRING "Unix socket of a resident generator started with \"ReflectGenerator --serve --socket=<path>\", targets fall back to their own generator process when nothing serves it")
+option(REFLECTION_GENERATOR_PROJECT_MODE "Generate the reflection of all targets declared with zeno_declare_reflection_support in one generator invocation" OFF)
+option(REFLECTION_GENERATOR_PROFILE "Print the reflection generator phase timings and write <target>.trace.json next to the generated headers" OFF)
+set(REFLECTION_GENERATOR_CACHE_DIR "${CMAKE_BINARY_DIR}/intermediate/reflection_cache" CACHE PATH "Directory where the reflection generator keeps data reused across runs")
 
 set(RELFECTION_GENERATION_ROOT_TARGET _Reflection_ROOT CACHE INTERNAL "Reflection generator dependencies for all targets")
 if(NOT TARGET _Reflection_ROOT)
@@ -70,6 +82,97 @@ function(get_prebuilt_generator generator_path)
     RETURN(PROPAGATE generator_path)
 endfunction()
 
+# Writes the manifest of all targets added with zeno_add_reflection_project_target and the single command generating them
+function(zeno_finalize_reflection_project)
+    get_property(project_entries GLOBAL PROPERTY ZENO_REFLECTION_PROJECT_ENTRIES)
+    get_property(project_headers GLOBAL PROPERTY ZENO_REFLECTION_PROJECT_HEADERS)
+    list(JOIN project_entries ",\n" project_entries_string)
+    list(JOIN REFLECTION_GENERATOR_PREAMBLE_HEADERS "," preamble_headers_string)
+
+    set(REFLECTION_PROJECT_DIR "${CMAKE_BINARY_DIR}/intermediate")
+    set(REFLECTION_PROJECT_MANIFEST "${REFLECTION_PROJECT_DIR}/reflection_project_$<CONFIG>.json")
+    set(TIMESTAMP_FILE "${CMAKE_BINARY_DIR}/timestamp/reflection_project_timestamp")
+    file(MAKE_DIRECTORY "${CMAKE_BINARY_DIR}/timestamp")
+
+    file(GENERATE OUTPUT "${REFLECTION_PROJECT_MANIFEST}" CONTENT "{
+\"common_args\": [
+    \"--pre_include_header=${LIBREFLECT_PCH_PATH}\",
+    \"--template_include=${REFLECT_TEMPLATE_INCLUDE}\",
+    \"--inja_dir=${INJA_TEMPLATE_DIR_PATH}\",
+    \"--jobs=${REFLECTION_GENERATOR_JOBS}\",
+    \"--emitter=${REFLECTION_GENERATOR_EMITTER}\",
+    \"--shards=${REFLECTION_GENERATOR_SHARDS}\",
+    $<$<BOOL:${REFLECTION_GENERATOR_BATCH}>:\"--batch\",>
+    $<$<BOOL:${REFLECTION_GENERATOR_PRECOMPILED_PREAMBLE}>:\"--precompiled_preamble\",>
+    $<$<BOOL:${REFLECTION_GENERATOR_INCREMENTAL}>:\"--incremental\",>
+    $<$<BOOL:${REFLECTION_GENERATOR_PROFILE}>:\"--time_report\",>
+    $<$<CONFIG:Debug>:\"-v\",>
+    \"--preamble_header=${preamble_headers_string}\",
+    \"--cache_dir=${REFLECTION_GENERATOR_CACHE_DIR}\",
+    \"--stdc++=${CMAKE_CXX_STANDARD}\"
+],
+\"targets\": [
+${project_entries_string}
+]
+}
+")
+
+    add_custom_command(
+        OUTPUT ${TIMESTAMP_FILE}
+        COMMAND ${CMAKE_COMMAND} -E touch ${TIMESTAMP_FILE}
+        COMMAND $<TARGET_FILE:ZenoReflect::generator>
+            --manifest="${REFLECTION_PROJECT_MANIFEST}"
+            --depfile="${TIMESTAMP_FILE}.d"
+            --depfile_target="${TIMESTAMP_FILE}"
+        DEPENDS ${project_headers} "${REFLECTION_PROJECT_MANIFEST}"
+        DEPFILE "${TIMESTAMP_FILE}.d"
+        COMMENT "Generating reflection information for all targets..."
+    )
+    add_custom_target(_internal_reflection_project_generation
+        DEPENDS ${TIMESTAMP_FILE}
+    )
+    add_dependencies(${RELFECTION_GENERATION_ROOT_TARGET} _internal_reflection_project_generation)
+endfunction(zeno_finalize_reflection_project)
+
+# Add ${target} to the manifest of REFLECTION_GENERATOR_PROJECT_MODE, the generation command is created once the top level directory is processed
+function(zeno_add_reflection_project_target target reflection_headers include_dirs header_output generated_source_path)
+    list(JOIN reflection_headers "," source_paths_string)
+    list(JOIN CMAKE_CXX_IMPLICIT_INCLUDE_DIRECTORIES "," SYSTEM_IMPLICIT_INCLUDE_DIRS)
+    set_property(GLOBAL APPEND PROPERTY ZENO_REFLECTION_PROJECT_ENTRIES "{
+    \"target\": \"${target}\",
+    \"args\": [
+        \"--target_name=${target}\",
+        \"--link_targets=$<JOIN:$<TARGET_PROPERTY:${target},LINK_LIBRARIES>,,>\",
+        \"--input_source=${source_paths_string}\",
+        \"--include_dirs=$<JOIN:${include_dirs},,>,${SYSTEM_IMPLICIT_INCLUDE_DIRS}\",
+        \"--header_output=${header_output}\",
+        $<$<BOOL:${REFLECTION_GENERATOR_PROFILE}>:\"--trace_out=${header_output}/${target}.trace.json\",>
+        \"--generated_source_path=${generated_source_path}\"
+    ]
+}")
+    set_property(GLOBAL APPEND PROPERTY ZENO_REFLECTION_PROJECT_HEADERS ${reflection_headers})
+
+    get_property(finalize_scheduled GLOBAL PROPERTY ZENO_REFLECTION_PROJECT_SCHEDULED)
+    if (NOT finalize_scheduled)
+        set_property(GLOBAL PROPERTY ZENO_REFLECTION_PROJECT_SCHEDULED TRUE)
+        cmake_language(DEFER DIRECTORY "${CMAKE_SOURCE_DIR}" CALL zeno_finalize_reflection_project)
+    endif()
+endfunction(zeno_add_reflection_project_target)
+
+# Register sources the generator writes for ${target}, must match zeno::reflect::get_register_source_shard_path
+function(zeno_get_reflection_register_sources target intermediate_dir shards result)
+    if (shards GREATER 1)
+        set(register_sources)
+        math(EXPR last_shard "${shards} - 1")
+        foreach(shard RANGE ${last_shard})
+            list(APPEND register_sources "${intermediate_dir}/${target}.generated.${shard}.cpp")
+        endforeach()
+    else()
+        set(register_sources "${intermediate_dir}/${target}.generated.cpp")
+    endif()
+    set(${result} ${register_sources} PARENT_SCOPE)
+endfunction(zeno_get_reflection_register_sources)
+
 function(zeno_declare_reflection_support target reflection_headers)
     set(generator_path "${CMAKE_BINARY_DIR}/ReflectGenerator-Prebuilt.exe")
     if (REFLECTION_USE_PREBUILT_BINARY AND WIN32)
@@ -83,8 +186,16 @@ function(zeno_declare_reflection_support target reflection_headers)
 
     set(INTERMEDIATE_FILE_DIR "${INTERMEDIATE_FILE_BASE_DIR}/${target}")
     set(INTERMEDIATE_ALL_IN_ONE_FILE "${INTERMEDIATE_FILE_DIR}/${target}.generated.cpp")
-    file(WRITE "${INTERMEDIATE_ALL_IN_ONE_FILE}" "// TBD by reflection generator\n")
-    target_sources(${target} PRIVATE "${INTERMEDIATE_ALL_IN_ONE_FILE}")
+    # The prebuilt generator only writes a single register source
+    set(register_shards ${REFLECTION_GENERATOR_SHARDS})
+    if (REFLECTION_USE_PREBUILT_BINARY AND WIN32)
+        set(register_shards 1)
+    endif()
+    zeno_get_reflection_register_sources(${target} "${INTERMEDIATE_FILE_DIR}" ${register_shards} REFLECTION_REGISTER_SOURCES)
+    foreach(register_source ${REFLECTION_REGISTER_SOURCES})
+        file(WRITE "${register_source}" "// TBD by reflection generator\n")
+    endforeach()
+    target_sources(${target} PRIVATE ${REFLECTION_REGISTER_SOURCES})
 
     # Input sources
     get_target_property(REFLECTION_GENERATION_SOURCE ${target} SOURCES)
@@ -95,6 +206,7 @@ function(zeno_declare_reflection_support target reflection_headers)
     endif()
     set(source_paths_value ${REFLECTION_GENERATION_SOURCE})
     list(JOIN reflection_headers ${splitor} source_paths_string)
+    list(JOIN REFLECTION_GENERATOR_PREAMBLE_HEADERS ${splitor} preamble_headers_string)
 
     # Include dirs
     set(INCLUDE_DIRS $<LIST:REMOVE_DUPLICATES,$<TARGET_PROPERTY:${target},INCLUDE_DIRECTORIES>>)
@@ -111,6 +223,17 @@ function(zeno_declare_reflection_support target reflection_headers)
         set(REFLECTION_GENERATED_DIR ${ZENO_REFLECTION_GENERATED_HEADERS_DIR})
     endif()
 
+    # "reflect/reflection.generated.hpp" resolves to the umbrella header of ${target} and the generated targets it links,
+    # other targets keep getting the one of every target from libgenerated
+    target_include_directories(${target} BEFORE PRIVATE "${REFLECTION_GENERATED_DIR}/reflect/${target}/include")
+
+    if (REFLECTION_GENERATOR_PROJECT_MODE AND NOT (REFLECTION_USE_PREBUILT_BINARY AND WIN32))
+        zeno_add_reflection_project_target(${target} "${reflection_headers}" "${INCLUDE_DIRS}" "${REFLECTION_GENERATED_DIR}" "${INTERMEDIATE_ALL_IN_ONE_FILE}")
+        add_dependencies(${target} ${RELFECTION_GENERATION_ROOT_TARGET})
+        target_link_libraries(${target} PUBLIC ZenoReflect::libreflect ZenoReflect::libgenerated)
+        return()
+    endif()
+
     if (REFLECTION_USE_PREBUILT_BINARY AND WIN32)
         add_custom_command(
             OUTPUT ${TIMESTAMP_FILE}
@@ -141,10 +264,25 @@ function(zeno_declare_reflection_support target reflection_headers)
                 --template_include="${REFLECT_TEMPLATE_INCLUDE}"
                 --inja_dir="${INJA_TEMPLATE_DIR_PATH}"
                 --stdc++=${CMAKE_CXX_STANDARD}
+                --jobs=${REFLECTION_GENERATOR_JOBS}
+                --emitter=${REFLECTION_GENERATOR_EMITTER}
+                --shards=${register_shards}
+                $<$<BOOL:${REFLECTION_GENERATOR_BATCH}>:--batch>
+                $<$<BOOL:${REFLECTION_GENERATOR_PRECOMPILED_PREAMBLE}>:--precompiled_preamble>
+                $<$<BOOL:${REFLECTION_GENERATOR_INCREMENTAL}>:--incremental>
+                $<$<BOOL:${REFLECTION_GENERATOR_PROFILE}>:--time_report>
+                $<$<BOOL:${REFLECTION_GENERATOR_PROFILE}>:--trace_out=${REFLECTION_GENERATED_DIR}/${target}.trace.json>
+                --preamble_header="${preamble_headers_string}"
+                --cache_dir="${REFLECTION_GENERATOR_CACHE_DIR}"
+                --server="${REFLECTION_GENERATOR_SERVER}"
+                --depfile="${TIMESTAMP_FILE}.d"
+                --depfile_target="${TIMESTAMP_FILE}"
                 $<IF:$<CONFIG:Debug>,-v,>
                 --generated_source_path="${INTERMEDIATE_ALL_IN_ONE_FILE}"
                 --target_name="${target}"
+                --link_targets=\"$<JOIN:$<TARGET_PROPERTY:${target},LINK_LIBRARIES>,${splitor}>\"
             DEPENDS ${reflection_headers}
+            DEPFILE "${TIMESTAMP_FILE}.d"
             COMMENT "Generating reflection information for ${target}..."
         )
     endif ()
@@ -173,8 +311,16 @@ function(zeno_generate_reflection_on_builddir target reflection_headers)
 
     set(INTERMEDIATE_FILE_DIR "${INTERMEDIATE_FILE_BASE_DIR}/${target}")
     set(INTERMEDIATE_ALL_IN_ONE_FILE "${INTERMEDIATE_FILE_DIR}/${target}.generated.cpp")
-    file(WRITE "${INTERMEDIATE_ALL_IN_ONE_FILE}" "// TBD by reflection generator\n")
-    target_sources(${target} PRIVATE "${INTERMEDIATE_ALL_IN_ONE_FILE}")
+    # The prebuilt generator only writes a single register source
+    set(register_shards ${REFLECTION_GENERATOR_SHARDS})
+    if (REFLECTION_USE_PREBUILT_BINARY AND WIN32)
+        set(register_shards 1)
+    endif()
+    zeno_get_reflection_register_sources(${target} "${INTERMEDIATE_FILE_DIR}" ${register_shards} REFLECTION_REGISTER_SOURCES)
+    foreach(register_source ${REFLECTION_REGISTER_SOURCES})
+        file(WRITE "${register_source}" "// TBD by reflection generator\n")
+    endforeach()
+    target_sources(${target} PRIVATE ${REFLECTION_REGISTER_SOURCES})
 
     # Input sources
     get_target_property(REFLECTION_GENERATION_SOURCE ${target} SOURCES)
@@ -185,6 +331,7 @@ function(zeno_generate_reflection_on_builddir target reflection_headers)
     endif()
     set(source_paths_value ${REFLECTION_GENERATION_SOURCE})
     list(JOIN reflection_headers ${splitor} source_paths_string)
+    list(JOIN REFLECTION_GENERATOR_PREAMBLE_HEADERS ${splitor} preamble_headers_string)
 
     # Include dirs
     set(INCLUDE_DIRS $<LIST:REMOVE_DUPLICATES,$<TARGET_PROPERTY:${target},INCLUDE_DIRECTORIES>>)
@@ -193,6 +340,9 @@ function(zeno_generate_reflection_on_builddir target reflection_headers)
 
     set(REFLECTION_GENERATION_TARGET _internal_${target}_reflect_generation)
 
+    # "reflect/reflection.generated.hpp" resolves to the umbrella header of ${target} and the generated targets it links
+    target_include_directories(${target} BEFORE PRIVATE "${INTERMEDIATE_FILE_DIR}/reflect/${target}/include")
+
     if (REFLECTION_USE_PREBUILT_BINARY AND WIN32)
         add_custom_target(${REFLECTION_GENERATION_TARGET}
             WORKING_DIRECTORY
@@ -209,7 +359,7 @@ function(zeno_generate_reflection_on_builddir target reflection_headers)
             WORKING_DIRECTORY
                 ${CMAKE_CURRENT_BINARY_DIR}
             COMMAND
-                $<TARGET_FILE:ZenoReflect::generator> --include_dirs=\"$<JOIN:${INCLUDE_DIRS},${splitor}>,${SYSTEM_IMPLICIT_INCLUDE_DIRS}\" --pre_include_header="${LIBREFLECT_PCH_PATH}" --input_source=\"${source_paths_string}\" --header_output="${INTERMEDIATE_FILE_DIR}" --stdc++=${CMAKE_CXX_STANDARD} $<IF:$<CONFIG:Debug>,-v,> --generated_source_path="${INTERMEDIATE_ALL_IN_ONE_FILE}" --target_name="${target}"
+                $<TARGET_FILE:ZenoReflect::generator> --include_dirs=\"$<JOIN:${INCLUDE_DIRS},${splitor}>,${SYSTEM_IMPLICIT_INCLUDE_DIRS}\" --pre_include_header="${LIBREFLECT_PCH_PATH}" --input_source=\"${source_paths_string}\" --header_output="${INTERMEDIATE_FILE_DIR}" --stdc++=${CMAKE_CXX_STANDARD} --jobs=${REFLECTION_GENERATOR_JOBS} --emitter=${REFLECTION_GENERATOR_EMITTER} --shards=${register_shards} $<$<BOOL:${REFLECTION_GENERATOR_BATCH}>:--batch> $<$<BOOL:${REFLECTION_GENERATOR_PRECOMPILED_PREAMBLE}>:--precompiled_preamble> $<$<BOOL:${REFLECTION_GENERATOR_INCREMENTAL}>:--incremental> $<$<BOOL:${REFLECTION_GENERATOR_PROFILE}>:--time_report> $<$<BOOL:${REFLECTION_GENERATOR_PROFILE}>:--trace_out=${INTERMEDIATE_FILE_DIR}/${target}.trace.json> --preamble_header="${preamble_headers_string}" --cache_dir="${REFLECTION_GENERATOR_CACHE_DIR}" --server="${REFLECTION_GENERATOR_SERVER}" $<IF:$<CONFIG:Debug>,-v,> --generated_source_path="${INTERMEDIATE_ALL_IN_ONE_FILE}" --target_name="${target}" --link_targets=\"$<JOIN:$<TARGET_PROPERTY:${target},LINK_LIBRARIES>,${splitor}>\"
             SOURCES
                 ${reflection_headers}
             COMMENT
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <type_traits>
+#include "reflect/macro.hpp"
+#include "reflect/type.hpp"
+#include "reflect/typeinfo.hpp"
+#include "reflect/container/any"
+#include "reflect/container/arraylist"
+#include "reflect/container/string"
+#include "reflect/metadata.hpp"
+
+/**
+ * Constant descriptor tables emitted by the reflection generator.
+ *
+ * The generator writes one table row per constructor, member function and field, with function pointers
+ * to small thunks for the parts that need the concrete type. The Table* classes below implement the
+ * reflection interfaces once for all types on top of those rows.
+*/
+
+namespace zeno
+{
+namespace reflect
+{
+    using RTTIGetter = const RTTITypeInfo& (*)();
+    using TypeHandleGetter = TypeHandle (*)();
+    using MetadataGetter = const IRawMetadata* (*)();
+    using AnyFactory = Any (*)();
+
+    /**
+     * Arguments passed to the generated thunks.
+     * Wraps both argument list forms accepted by the reflection interfaces without copying them.
+    */
+    class InvokeArguments {
+    public:
+        InvokeArguments(const ArrayList<Any>& values) : m_values(&values) {}
+        InvokeArguments(const ArrayList<Any*>& pointers) : m_pointers(&pointers) {}
+
+        LIBREFLECT_INLINE Any& operator[](size_t index) const {
+            if (nullptr != m_values) {
+                return const_cast<Any&>((*m_values)[index]);
+            }
+            return *(*m_pointers)[index];
+        }
+
+    private:
+        const ArrayList<Any>* m_values = nullptr;
+        const ArrayList<Any*>* m_pointers = nullptr;
+    };
+
+    struct ParamDescriptor {
+        const char* name;
+        RTTIGetter type;
+        RTTIGetter decayed_type;
+        /// Default argument, nullptr if the parameter has none
+        AnyFactory default_value;
+        /// Value initialized argument
+        AnyFactory init_value;
+    };
+
+    struct ConstructorDescriptor {
+        const ParamDescriptor* params;
+        size_t num_params;
+        void* (*new_instance)(const InvokeArguments& args);
+        Any (*create_instance)(const InvokeArguments& args);
+    };
+
+    struct FunctionDescriptor {
+        const char* name;
+        const ParamDescriptor* params;
+        size_t num_params;
+        TypeHandleGetter return_type;
+        RTTIGetter return_rtti;
+        bool is_static;
+        bool is_const;
+        bool is_noexcept;
+        /// Calls the function on `object`, static functions ignore it
+        Any (*invoke)(void* object, const InvokeArguments& args);
+        /// nullptr if the function has no metadata
+        MetadataGetter metadata;
+    };
+
+    struct FieldDescriptor {
+        const char* name;
+        TypeHandleGetter type;
+        void* (*field_ptr)(void* object);
+        Any (*get_value)(void* object);
+        void (*set_value)(void* object, Any& value);
+        /// nullptr if the field has no metadata
+        MetadataGetter metadata;
+    };
+
+    struct TypeDescriptor {
+        RTTIGetter rtti;
+        /// Address of the object held by an Any of this type
+        void* (*object_ptr)(Any& object);
+        const ConstructorDescriptor* ctors;
+        size_t num_ctors;
+        const FunctionDescriptor* funcs;
+        size_t num_funcs;
+        const FieldDescriptor* fields;
+        size_t num_fields;
+        const TypeHandleGetter* bases;
+        size_t num_bases;
+        MetadataGetter metadata;
+    };
+
+    /// Shared thunks instantiated by the generated tables
+    namespace thunks
+    {
+        template <typename T>
+        Any init_value() {
+            return make_any<T>();
+        }
+
+        template <typename T>
+        void* object_ptr(Any& object) {
+            return &any_cast<T&>(object);
+        }
+
+        template <typename TMemberPointer>
+        struct TMemberFieldTraits;
+
+        template <typename TClass, typename TField>
+        struct TMemberFieldTraits<TField TClass::*> {
+            using ClassType = TClass;
+            using FieldType = TField;
+        };
+
+        template <auto Field>
+        void* field_ptr(void* object) {
+            using ClassType = typename TMemberFieldTraits<decltype(Field)>::ClassType;
+            if (!object) return nullptr;
+            return &(static_cast<ClassType*>(object)->*Field);
+        }
+
+        template <auto Field>
+        Any get_field_value(void* object) {
+            using ClassType = typename TMemberFieldTraits<decltype(Field)>::ClassType;
+            if (!object) return Any();
+            return static_cast<ClassType*>(object)->*Field;
+        }
+
+        template <auto Field>
+        void set_field_value(void* object, Any& value) {
+            using Traits = TMemberFieldTraits<decltype(Field)>;
+            if (!object) return;
+            static_cast<typename Traits::ClassType*>(object)->*Field = any_cast<typename Traits::FieldType>(value);
+        }
+    }
+
+    class LIBREFLECT_API TableTypeConstructor final : public ITypeConstructor {
+    public:
+        TableTypeConstructor(const TypeHandle& in_type, const ConstructorDescriptor& descriptor);
+
+        virtual const ArrayList<RTTITypeInfo>& get_params() const override;
+        virtual const ArrayList<RTTITypeInfo>& get_params_dacayed() const override;
+        virtual const ArrayList<StringView>& get_params_name() const override;
+        virtual Any get_param_default_value(size_t index) override;
+        virtual Any init_param_default_value(size_t index) override;
+        virtual void* new_instance(const ArrayList<Any>& params) const override;
+        virtual Any create_instance(const ArrayList<Any>& params) const override;
+
+    private:
+        const ConstructorDescriptor& m_descriptor;
+        ArrayList<RTTITypeInfo> m_params;
+        ArrayList<RTTITypeInfo> m_params_decayed;
+        ArrayList<StringView> m_params_name;
+    };
+
+    class LIBREFLECT_API TableMemberFunction final : public IMemberFunction {
+    public:
+        TableMemberFunction(const TypeHandle& in_type, const TypeDescriptor& type, const FunctionDescriptor& descriptor);
+
+        virtual const ArrayList<RTTITypeInfo>& get_params() const override;
+        virtual const ArrayList<RTTITypeInfo>& get_params_dacayed() const override;
+        virtual const ArrayList<StringView>& get_params_name() const override;
+        virtual Any get_param_default_value(size_t index) override;
+        virtual Any init_param_default_value(size_t index) override;
+        virtual TypeHandle get_return_type() const override;
+        virtual const RTTITypeInfo& get_return_rtti() const override;
+        virtual Any invoke(const Any& clazz_object, const ArrayList<Any>& params) const override;
+        virtual Any invoke(const Any& clazz_object, const ArrayList<Any*>& params) const override;
+        virtual Any invoke_unsafe(void* clazz_object, const ArrayList<Any>& params) const override;
+        virtual Any invoke_static(const ArrayList<Any>& params) const override;
+        virtual Any invoke_static(const ArrayList<Any*>& params) const override;
+        virtual StringView get_name() override;
+        virtual bool is_static() const override;
+        virtual bool is_const() const override;
+        virtual bool is_no_except() const override;
+        virtual const IRawMetadata* get_metadata() const override;
+
+    private:
+        void* get_object_ptr(const Any& clazz_object) const;
+
+        const TypeDescriptor& m_type_descriptor;
+        const FunctionDescriptor& m_descriptor;
+        ArrayList<RTTITypeInfo> m_params;
+        ArrayList<RTTITypeInfo> m_params_decayed;
+        ArrayList<StringView> m_params_name;
+    };
+
+    class LIBREFLECT_API TableMemberField final : public IMemberField {
+    public:
+        TableMemberField(const TypeHandle& in_type, const TypeDescriptor& type, const FieldDescriptor& descriptor);
+
+        virtual void* get_field_ptr(const Any& clazz_object) const override;
+        virtual void* get_field_ptr_directly(void* this_object) const override;
+        virtual Any get_field_value(void* this_object) const override;
+        virtual void set_field_value(void* this_object, Any value) const override;
+        virtual TypeHandle get_field_type() const override;
+        virtual StringView get_name() override;
+        virtual const IRawMetadata* get_metadata() const override;
+
+    private:
+        const TypeDescriptor& m_type_descriptor;
+        const FieldDescriptor& m_descriptor;
+    };
+
+    /**
+     * Reflected record type backed by a generated TypeDescriptor.
+     * Member wrappers are created on first access, registering a type only allocates this object.
+    */
+    class LIBREFLECT_API TableType final : public TypeBase {
+    public:
+        TableType(const ReflectedTypeInfo& type_info, const TypeDescriptor& descriptor);
+        virtual ~TableType();
+
+        virtual std::size_t type_hash() const override;
+        virtual const RTTITypeInfo& get_rtti_info() const override;
+        virtual const ArrayList<ITypeConstructor*>& get_constructors() const override;
+        virtual const ArrayList<IMemberFunction*>& get_member_functions() const override;
+        virtual const ArrayList<IMemberField*>& get_member_fields() const override;
+        virtual const ArrayList<TypeHandle>& get_base_classes() const override;
+        virtual const IRawMetadata* get_metadata() const override;
+
+    private:
+        void ensure_members() const;
+
+        const TypeDescriptor& m_descriptor;
+        mutable std::once_flag m_members_once;
+        mutable ArrayList<ITypeConstructor*> m_ctors;
+        mutable ArrayList<IMemberFunction*> m_funcs;
+        mutable ArrayList<IMemberField*> m_fields;
+        mutable ArrayList<TypeHandle> m_bases;
+    };
+}
+}
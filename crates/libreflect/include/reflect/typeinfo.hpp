@@ -61,18 +61,150 @@ namespace reflect
         size_t m_decayed_hash = 0;
     };
 
-    // SFINAE
+    namespace rtti
+    {
+        /**
+         * Outermost qualifier of T: a reference, cv-qualification or pointer.
+         * `Inner` is T with it removed, `tag` is 0 for types without one.
+         * Names are spelled like clang prints them, "const T", "T *", "T **" and "T *const &".
+        */
+        template <typename T>
+        struct TQualifierStep {
+            using Inner = T;
+            static constexpr char tag = 0;
+            static constexpr const char* prefix = "";
+            static constexpr const char* suffix = "";
+        };
+
+        template <typename T>
+        struct TQualifierStep<T&> {
+            using Inner = T;
+            static constexpr char tag = '&';
+            static constexpr const char* prefix = "";
+            static constexpr const char* suffix = "&";
+        };
+
+        template <typename T>
+        struct TQualifierStep<T&&> {
+            using Inner = T;
+            static constexpr char tag = 'R';
+            static constexpr const char* prefix = "";
+            static constexpr const char* suffix = "&&";
+        };
+
+        template <typename T>
+        struct TQualifierStep<T*> {
+            using Inner = T;
+            static constexpr char tag = '*';
+            static constexpr const char* prefix = "";
+            static constexpr const char* suffix = "*";
+        };
+
+        // A qualified pointer is spelled "T *const" instead of "const T"
+        template <typename T>
+        struct TQualifierStep<const T> {
+            using Inner = T;
+            static constexpr char tag = 'C';
+            static constexpr const char* prefix = TIsPointer<T>::value ? "" : "const ";
+            static constexpr const char* suffix = TIsPointer<T>::value ? "const" : "";
+        };
+
+        template <typename T>
+        struct TQualifierStep<volatile T> {
+            using Inner = T;
+            static constexpr char tag = 'V';
+            static constexpr const char* prefix = TIsPointer<T>::value ? "" : "volatile ";
+            static constexpr const char* suffix = TIsPointer<T>::value ? "volatile" : "";
+        };
+
+        template <typename T>
+        struct TQualifierStep<const volatile T> {
+            using Inner = T;
+            static constexpr char tag = 'W';
+            static constexpr const char* prefix = TIsPointer<T>::value ? "" : "const volatile ";
+            static constexpr const char* suffix = TIsPointer<T>::value ? "const volatile" : "";
+        };
+
+        template <typename T>
+        LIBREFLECT_INLINE REFLECT_FORCE_CONSTEPXR bool VTIsQualifiedType = TQualifierStep<T>::tag != 0;
+
+        /**
+         * `prefix`, `name` and `suffix` joined with a space in front of the suffix unless `name` already ends with a pointer or reference,
+         * allocated once and kept for the lifetime of the program like the names of generated RTTI.
+        */
+        LIBREFLECT_API const char* make_qualified_type_name(const char* prefix, const char* name, const char* suffix);
+
+        /**
+         * Hash of a type named `name`, the same FNV-1a hash of its spelling the generator gives the types it generates.
+         * The generator hashes the spelling before turning "_Bool" into "bool", so "bool" is hashed as "_Bool" here.
+        */
+        LIBREFLECT_API size_t hash_type_name(const char* name);
+
+        template <typename T>
+        struct TQualifiedTypeInfo;
+    }
+
+    /**
+     * RTTI of `T`.
+     * The generator specializes it for canonical unqualified types only, references, cv-qualified and pointer types are derived
+     * from those by rtti::TQualifiedTypeInfo.
+    */
     template <typename T>
     static REFLECT_STATIC_CONSTEXPR const RTTITypeInfo& type_info() {
-        static REFLECT_STATIC_CONSTEXPR RTTITypeInfo Default = {"<default_type>", 0, 0 }; 
+        if REFLECT_FORCE_CONSTEPXR (rtti::VTIsQualifiedType<T>) {
+            return rtti::TQualifiedTypeInfo<T>::get();
+        } else {
+            static REFLECT_STATIC_CONSTEXPR RTTITypeInfo Default = {"<default_type>", 0, 0 }; 
 #ifdef ZENO_REFLECT_PROCESSING
-        return Default;
+            return Default;
 #else
 
-        // IDK why some old MSVC will instantiate this template in libreflect
-        static_assert(AlwaysFalse<T>::value, "\r\n==== Reflection Error ====\r\nThe type_info of current type not implemented. Have you marked it out ?\r\nTry '#include \"reflect/reflection.generated.hpp\"' in the traslation unit where you used zeno::reflect::type_info. \r\n==== Reflection Error End ====");
-        return Default;
+            // IDK why some old MSVC will instantiate this template in libreflect
+            static_assert(AlwaysFalse<T>::value, "\r\n==== Reflection Error ====\r\nThe type_info of current type not implemented. Have you marked it out ?\r\nTry '#include \"reflect/reflection.generated.hpp\"' in the traslation unit where you used zeno::reflect::type_info. \r\n==== Reflection Error End ====");
+            return Default;
 #endif
+        }
+    }
+
+    namespace rtti
+    {
+        /**
+         * RTTI of a qualified type, built from the RTTI of the type it qualifies.
+         * Name, hash, flags and the decayed hash are what the generator used to emit for these variants.
+        */
+        template <typename T>
+        struct TQualifiedTypeInfo {
+            using Step = TQualifierStep<T>;
+            using DecayedType = typename TRemoveCV<TTRemoveReference<TTRemovePointer<typename TRemoveCV<T>::Type>>>::Type;
+
+            static const RTTITypeInfo& get() {
+                static const RTTITypeInfo s = make();
+                return s;
+            }
+
+        private:
+            static RTTITypeInfo make() {
+                const RTTITypeInfo& inner = type_info<typename Step::Inner>();
+                using NonRef = TTRemoveReference<T>;
+                size_t flags = TF_None;
+                if (VTIsPointer<typename TRemoveCV<NonRef>::Type>) {
+                    flags |= TF_IsPointer;
+                }
+                if (VTIsConst<NonRef>) {
+                    flags |= TF_IsConst;
+                }
+                if (VTIsReference<T>) {
+                    flags |= Step::tag == '&' ? TF_IsLValueRef : TF_IsRValueRef;
+                }
+                const char* name = make_qualified_type_name(Step::prefix, inner.name(), Step::suffix);
+                return RTTITypeInfo(
+                    name,
+                    hash_type_name(name),
+                    flags,
+                    type_info<DecayedType>().hash_code()
+                );
+            }
+        };
     }
 
     // We need to instantiate type_info<void> here for Any
@@ -0,0 +1,336 @@
+#include "reflect/descriptor.hpp"
+
+using namespace zeno::reflect;
+
+namespace
+{
+    void fill_param_lists(const ParamDescriptor* params, size_t num_params, ArrayList<RTTITypeInfo>& types, ArrayList<RTTITypeInfo>& decayed_types, ArrayList<StringView>& names)
+    {
+        for (size_t i = 0; i < num_params; ++i) {
+            types.add_item(params[i].type());
+            decayed_types.add_item(params[i].decayed_type());
+            names.add_item(StringView(params[i].name));
+        }
+    }
+
+    Any param_default_value(const ParamDescriptor* params, size_t num_params, size_t index)
+    {
+        if (index < num_params && nullptr != params[index].default_value) {
+            return params[index].default_value();
+        }
+        return Any::make_null();
+    }
+
+    Any param_init_value(const ParamDescriptor* params, size_t num_params, size_t index)
+    {
+        if (index < num_params && nullptr != params[index].init_value) {
+            return params[index].init_value();
+        }
+        return Any::make_null();
+    }
+}
+
+zeno::reflect::TableTypeConstructor::TableTypeConstructor(const TypeHandle& in_type, const ConstructorDescriptor& descriptor)
+    : ITypeConstructor(in_type)
+    , m_descriptor(descriptor)
+    , m_params(descriptor.num_params)
+    , m_params_decayed(descriptor.num_params)
+    , m_params_name(descriptor.num_params)
+{
+    fill_param_lists(descriptor.params, descriptor.num_params, m_params, m_params_decayed, m_params_name);
+}
+
+const ArrayList<RTTITypeInfo>& zeno::reflect::TableTypeConstructor::get_params() const
+{
+    return m_params;
+}
+
+const ArrayList<RTTITypeInfo>& zeno::reflect::TableTypeConstructor::get_params_dacayed() const
+{
+    return m_params_decayed;
+}
+
+const ArrayList<StringView>& zeno::reflect::TableTypeConstructor::get_params_name() const
+{
+    return m_params_name;
+}
+
+Any zeno::reflect::TableTypeConstructor::get_param_default_value(size_t index)
+{
+    return param_default_value(m_descriptor.params, m_descriptor.num_params, index);
+}
+
+Any zeno::reflect::TableTypeConstructor::init_param_default_value(size_t index)
+{
+    return param_init_value(m_descriptor.params, m_descriptor.num_params, index);
+}
+
+void* zeno::reflect::TableTypeConstructor::new_instance(const ArrayList<Any>& params) const
+{
+    if (is_suitable_to_invoke(params)) {
+        return m_descriptor.new_instance(InvokeArguments(params));
+    }
+    return nullptr;
+}
+
+Any zeno::reflect::TableTypeConstructor::create_instance(const ArrayList<Any>& params) const
+{
+    if (is_suitable_to_invoke(params)) {
+        return m_descriptor.create_instance(InvokeArguments(params));
+    }
+    return Any();
+}
+
+zeno::reflect::TableMemberFunction::TableMemberFunction(const TypeHandle& in_type, const TypeDescriptor& type, const FunctionDescriptor& descriptor)
+    : IMemberFunction(in_type)
+    , m_type_descriptor(type)
+    , m_descriptor(descriptor)
+    , m_params(descriptor.num_params)
+    , m_params_decayed(descriptor.num_params)
+    , m_params_name(descriptor.num_params)
+{
+    fill_param_lists(descriptor.params, descriptor.num_params, m_params, m_params_decayed, m_params_name);
+}
+
+const ArrayList<RTTITypeInfo>& zeno::reflect::TableMemberFunction::get_params() const
+{
+    return m_params;
+}
+
+const ArrayList<RTTITypeInfo>& zeno::reflect::TableMemberFunction::get_params_dacayed() const
+{
+    return m_params_decayed;
+}
+
+const ArrayList<StringView>& zeno::reflect::TableMemberFunction::get_params_name() const
+{
+    return m_params_name;
+}
+
+Any zeno::reflect::TableMemberFunction::get_param_default_value(size_t index)
+{
+    return param_default_value(m_descriptor.params, m_descriptor.num_params, index);
+}
+
+Any zeno::reflect::TableMemberFunction::init_param_default_value(size_t index)
+{
+    return param_init_value(m_descriptor.params, m_descriptor.num_params, index);
+}
+
+TypeHandle zeno::reflect::TableMemberFunction::get_return_type() const
+{
+    return m_descriptor.return_type();
+}
+
+const RTTITypeInfo& zeno::reflect::TableMemberFunction::get_return_rtti() const
+{
+    return m_descriptor.return_rtti();
+}
+
+void* zeno::reflect::TableMemberFunction::get_object_ptr(const Any& clazz_object) const
+{
+    if (clazz_object.type() == m_type_descriptor.rtti()) {
+        return m_type_descriptor.object_ptr(const_cast<Any&>(clazz_object));
+    }
+    return nullptr;
+}
+
+Any zeno::reflect::TableMemberFunction::invoke(const Any& clazz_object, const ArrayList<Any>& params) const
+{
+    if (m_descriptor.is_static) {
+        return invoke_static(params);
+    }
+    if (void* object = get_object_ptr(clazz_object); nullptr != object && is_suitable_to_invoke(params)) {
+        return m_descriptor.invoke(object, InvokeArguments(params));
+    }
+    return Any::make_null();
+}
+
+Any zeno::reflect::TableMemberFunction::invoke(const Any& clazz_object, const ArrayList<Any*>& params) const
+{
+    if (m_descriptor.is_static) {
+        return invoke_static(params);
+    }
+    if (void* object = get_object_ptr(clazz_object); nullptr != object && is_suitable_to_invoke(params)) {
+        return m_descriptor.invoke(object, InvokeArguments(params));
+    }
+    return Any::make_null();
+}
+
+Any zeno::reflect::TableMemberFunction::invoke_unsafe(void* clazz_object, const ArrayList<Any>& params) const
+{
+    if (m_descriptor.is_static) {
+        return invoke_static(params);
+    }
+    if (is_suitable_to_invoke(params)) {
+        return m_descriptor.invoke(clazz_object, InvokeArguments(params));
+    }
+    return Any::make_null();
+}
+
+Any zeno::reflect::TableMemberFunction::invoke_static(const ArrayList<Any>& params) const
+{
+    if (m_descriptor.is_static && is_suitable_to_invoke(params)) {
+        return m_descriptor.invoke(nullptr, InvokeArguments(params));
+    }
+    return Any::make_null();
+}
+
+Any zeno::reflect::TableMemberFunction::invoke_static(const ArrayList<Any*>& params) const
+{
+    if (m_descriptor.is_static && is_suitable_to_invoke(params)) {
+        return m_descriptor.invoke(nullptr, InvokeArguments(params));
+    }
+    return Any::make_null();
+}
+
+StringView zeno::reflect::TableMemberFunction::get_name()
+{
+    return m_descriptor.name;
+}
+
+bool zeno::reflect::TableMemberFunction::is_static() const
+{
+    return m_descriptor.is_static;
+}
+
+bool zeno::reflect::TableMemberFunction::is_const() const
+{
+    return m_descriptor.is_const;
+}
+
+bool zeno::reflect::TableMemberFunction::is_no_except() const
+{
+    return m_descriptor.is_noexcept;
+}
+
+const IRawMetadata* zeno::reflect::TableMemberFunction::get_metadata() const
+{
+    return nullptr != m_descriptor.metadata ? m_descriptor.metadata() : nullptr;
+}
+
+zeno::reflect::TableMemberField::TableMemberField(const TypeHandle& in_type, const TypeDescriptor& type, const FieldDescriptor& descriptor)
+    : IMemberField(in_type)
+    , m_type_descriptor(type)
+    , m_descriptor(descriptor)
+{
+}
+
+void* zeno::reflect::TableMemberField::get_field_ptr(const Any& clazz_object) const
+{
+    if (clazz_object.type() == m_type_descriptor.rtti()) {
+        return m_descriptor.field_ptr(m_type_descriptor.object_ptr(const_cast<Any&>(clazz_object)));
+    }
+    return nullptr;
+}
+
+void* zeno::reflect::TableMemberField::get_field_ptr_directly(void* this_object) const
+{
+    return m_descriptor.field_ptr(this_object);
+}
+
+Any zeno::reflect::TableMemberField::get_field_value(void* this_object) const
+{
+    return m_descriptor.get_value(this_object);
+}
+
+void zeno::reflect::TableMemberField::set_field_value(void* this_object, Any value) const
+{
+    m_descriptor.set_value(this_object, value);
+}
+
+TypeHandle zeno::reflect::TableMemberField::get_field_type() const
+{
+    return m_descriptor.type();
+}
+
+StringView zeno::reflect::TableMemberField::get_name()
+{
+    return m_descriptor.name;
+}
+
+const IRawMetadata* zeno::reflect::TableMemberField::get_metadata() const
+{
+    return nullptr != m_descriptor.metadata ? m_descriptor.metadata() : nullptr;
+}
+
+zeno::reflect::TableType::TableType(const ReflectedTypeInfo& type_info, const TypeDescriptor& descriptor)
+    : TypeBase(type_info)
+    , m_descriptor(descriptor)
+    , m_ctors(descriptor.num_ctors)
+    , m_funcs(descriptor.num_funcs)
+    , m_fields(descriptor.num_fields)
+    , m_bases(descriptor.num_bases)
+{
+}
+
+zeno::reflect::TableType::~TableType()
+{
+    for (ITypeConstructor* ctor : m_ctors) {
+        delete ctor;
+    }
+    for (IMemberFunction* func : m_funcs) {
+        delete func;
+    }
+    for (IMemberField* field : m_fields) {
+        delete field;
+    }
+}
+
+void zeno::reflect::TableType::ensure_members() const
+{
+    std::call_once(m_members_once, [this] () {
+        const TypeHandle parent = TypeHandle(m_descriptor.rtti());
+        for (size_t i = 0; i < m_descriptor.num_ctors; ++i) {
+            m_ctors.add_item(new TableTypeConstructor(parent, m_descriptor.ctors[i]));
+        }
+        for (size_t i = 0; i < m_descriptor.num_funcs; ++i) {
+            m_funcs.add_item(new TableMemberFunction(parent, m_descriptor, m_descriptor.funcs[i]));
+        }
+        for (size_t i = 0; i < m_descriptor.num_fields; ++i) {
+            m_fields.add_item(new TableMemberField(parent, m_descriptor, m_descriptor.fields[i]));
+        }
+        for (size_t i = 0; i < m_descriptor.num_bases; ++i) {
+            m_bases.add_item(m_descriptor.bases[i]());
+        }
+    });
+}
+
+std::size_t zeno::reflect::TableType::type_hash() const
+{
+    return get_rtti_info().hash_code();
+}
+
+const RTTITypeInfo& zeno::reflect::TableType::get_rtti_info() const
+{
+    return m_descriptor.rtti();
+}
+
+const ArrayList<ITypeConstructor*>& zeno::reflect::TableType::get_constructors() const
+{
+    ensure_members();
+    return m_ctors;
+}
+
+const ArrayList<IMemberFunction*>& zeno::reflect::TableType::get_member_functions() const
+{
+    ensure_members();
+    return m_funcs;
+}
+
+const ArrayList<IMemberField*>& zeno::reflect::TableType::get_member_fields() const
+{
+    ensure_members();
+    return m_fields;
+}
+
+const ArrayList<TypeHandle>& zeno::reflect::TableType::get_base_classes() const
+{
+    ensure_members();
+    return m_bases;
+}
+
+const IRawMetadata* zeno::reflect::TableType::get_metadata() const
+{
+    return nullptr != m_descriptor.metadata ? m_descriptor.metadata() : nullptr;
+}
@@ -1,3 +1,6 @@
+#include <cstdint>
+#include <cstring>
+#include <string_view>
 #include "reflect/typeinfo.hpp"
 #include "container/string"
 #include "typeinfo.hpp"
@@ -89,3 +92,60 @@ bool zeno::reflect::RTTITypeInfo::operator!=(const RTTITypeInfo &other) const
 {
     return !operator==(other);
 }
+
+const char* zeno::reflect::rtti::make_qualified_type_name(const char* prefix, const char* name, const char* suffix)
+{
+    const size_t prefix_length = std::strlen(prefix);
+    const size_t name_length = std::strlen(name);
+    const size_t suffix_length = std::strlen(suffix);
+    // "int *" and "int &" but "int **" and "int *&"
+    const bool separated = suffix_length > 0 && (name_length == 0 || (name[name_length - 1] != '*' && name[name_length - 1] != '&'));
+    const size_t separator_length = separated ? 1 : 0;
+    // Lives as long as the program, same as the literals generated for unqualified types
+    char* result = new char[prefix_length + name_length + separator_length + suffix_length + 1];
+    std::memcpy(result, prefix, prefix_length);
+    std::memcpy(result + prefix_length, name, name_length);
+    if (separated) {
+        result[prefix_length + name_length] = ' ';
+    }
+    std::memcpy(result + prefix_length + name_length + separator_length, suffix, suffix_length + 1);
+    return result;
+}
+
+size_t zeno::reflect::rtti::hash_type_name(const char* name)
+{
+    constexpr uint64_t offset_basis = 14695981039346656037ULL;
+    constexpr uint64_t prime = 1099511628211ULL;
+    constexpr uint32_t offset_basis_32 = 2166136261U;
+    constexpr uint32_t prime_32 = 16777619U;
+
+    auto is_identifier_char = [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    };
+
+    uint64_t hash = offset_basis;
+    uint32_t hash_32 = offset_basis_32;
+    auto mix = [&hash, &hash_32, prime, prime_32](unsigned char c) {
+        hash = (hash ^ c) * prime;
+        hash_32 = (hash_32 ^ c) * prime_32;
+    };
+
+    const size_t length = std::strlen(name);
+    for (size_t i = 0; i < length; ++i) {
+        const bool starts_word = i == 0 || !is_identifier_char(name[i - 1]);
+        if (starts_word && std::strncmp(name + i, "bool", 4) == 0 && (i + 4 == length || !is_identifier_char(name[i + 4]))) {
+            for (const char c : std::string_view("_Bool")) {
+                mix(static_cast<unsigned char>(c));
+            }
+            i += 3;
+            continue;
+        }
+        mix(static_cast<unsigned char>(name[i]));
+    }
+
+    if constexpr (sizeof(size_t) == sizeof(uint32_t)) {
+        return hash_32;
+    } else {
+        return static_cast<size_t>(hash);
+    }
+}
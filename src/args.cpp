@@ -4,4 +4,13 @@ ControlFlags parse_args(int argc, char* argv[]) {
     return argparse::parse<ControlFlags>(argc, argv);
 }
 
+ControlFlags parse_args(const std::vector<std::string>& args) {
+    std::vector<const char*> argv;
+    argv.reserve(args.size());
+    for (const std::string& arg : args) {
+        argv.push_back(arg.c_str());
+    }
+    return argparse::parse<ControlFlags>(static_cast<int>(argv.size()), argv.data(), true);
+}
+
 ControlFlags* GLOBAL_CONTROL_FLAGS = nullptr;
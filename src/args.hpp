@@ -11,10 +11,52 @@ struct ControlFlags : public argparse::Args {
     std::vector<std::string>& include_dirs = kwarg("I,include_dirs", "Include directories").multi_argument().set_default(std::vector<std::string>{});
     std::vector<std::string>& pre_include_headers = kwarg("H,pre_include_header", "Automatic place those headers in all sources").set_default(std::vector<std::string>{});
     std::string& target_name = kwarg("T,target_name", "Target name of generating target");
+    std::vector<std::string>& link_targets = kwarg("link_targets", "Targets linked by the generating target, its umbrella header includes those generated as well").set_default(std::vector<std::string>{});
     std::string& template_include = kwarg("template_include", "include headers in the template").set_default("");
     std::string& inja_dir = kwarg("inja_dir", "the dir of inja template file").set_default("");
+    std::string& cache_dir = kwarg("cache_dir", "Directory keeping data reused across runs (default: <header_output>/.cache)").set_default("");
+    bool& precompiled_preamble = flag("precompiled_preamble", "Precompile pre-include headers and preamble headers once and reuse them for every header");
+    std::vector<std::string>& preamble_headers = kwarg("preamble_header", "Extra heavy headers (e.g. vector,string) added to the precompiled preamble").set_default(std::vector<std::string>{});
+    bool& incremental = flag("incremental", "Serve headers whose content, includes and generator flags are unchanged from the cache in --cache_dir");
+    std::string& depfile = kwarg("depfile", "Write a Makefile style depfile listing every header the generated files depend on").set_default("");
+    std::string& depfile_target = kwarg("depfile_target", "Output named as the target of the depfile (default: --generated_source_path)").set_default("");
+    std::string& emitter = kwarg("emitter", "Code emitter backend, \"inja\" renders the templates, \"native\" writes the same code directly without json trees and ignores --inja_dir (default: inja)").set_default("inja");
+    int& shards = kwarg("shards", "Split --generated_source_path into this many files <name>.<N>.cpp of similar size (default: 1)").set_default(1);
+    bool& time_report = flag("time_report", "Print the time spent in each generator phase, the slowest headers and the peak resident memory");
+    std::string& trace_out = kwarg("trace_out", "Write the generator phases as a Chrome trace event file, viewable in chrome://tracing or Perfetto").set_default("");
+    bool& parse_function_bodies = flag("parse_function_bodies", "Parse and check the bodies of inline functions, only useful to compare against the default declaration only parse");
+    bool& no_prescan = flag("no_prescan", "Parse every input header through clang, including those the textual pre-scan finds no reflection macro in");
+    bool& batch = flag("batch", "Parse input headers through one synthetic translation unit per job instead of one per header");
+    int& jobs = kwarg("j,jobs", "Number of headers parsed in parallel, 0 means using all hardware threads (default: 1)").set_default(1);
+    std::string& server = kwarg("server", "Unix socket of a generator started with --serve, the request runs there and locally if the server can't be reached").set_default("");
+};
+
+/**
+ * Options of a resident generator, started with `--serve` as the first argument.
+*/
+struct ServeFlags : public argparse::Args {
+    bool& serve = flag("serve", "Stay resident and run the requests of --server clients one after another");
+    std::string& socket = kwarg("socket", "Unix socket path to listen on");
+    int& idle_timeout = kwarg("idle_timeout", "Exit after this many seconds without a request, 0 means never (default: 0)").set_default(0);
+};
+
+/**
+ * Options of a project wide run, started with `--manifest` as the first argument.
+ * The manifest is a JSON object {"common_args": [...], "targets": [{"target": "<name>", "args": [...]}]},
+ * each target is generated as if the generator was called with the common arguments followed by its own.
+*/
+struct ManifestFlags : public argparse::Args {
+    std::string& manifest = kwarg("manifest", "JSON file listing the targets to generate");
+    std::string& depfile = kwarg("depfile", "Write a Makefile style depfile listing every header the outputs of all targets depend on").set_default("");
+    std::string& depfile_target = kwarg("depfile_target", "Output named as the target of the depfile (default: --manifest)").set_default("");
 };
 
 ControlFlags parse_args(int argc, char** argv);
 
+/**
+ * Parse the command line of a request sent to a resident generator.
+ * Throws std::runtime_error instead of exiting on invalid arguments.
+*/
+ControlFlags parse_args(const std::vector<std::string>& args);
+
 extern ControlFlags* GLOBAL_CONTROL_FLAGS;
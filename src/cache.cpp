@@ -0,0 +1,194 @@
+#include <fstream>
+#include <system_error>
+#include <chrono>
+#include "cache.hpp"
+#include "args.hpp"
+#include "log.hpp"
+#include "utils.hpp"
+#include "template/template_literal"
+
+namespace
+{
+    /// Bump when the layout of cached results changes
+    constexpr int REFLECTION_CACHE_VERSION = 3;
+
+    /// Files modified this close to the last cache write are re-hashed, their stamps can't be trusted
+    constexpr std::chrono::seconds STAMP_RESOLUTION { 2 };
+}
+
+size_t zeno::reflect::compute_generation_flags_hash()
+{
+    std::string flags = std::format("{}\n", REFLECTION_CACHE_VERSION);
+    for (const std::string& arg : get_generator_command_args()) {
+        flags += arg + "\n";
+    }
+    flags += GLOBAL_CONTROL_FLAGS->target_name + "\n";
+    flags += GLOBAL_CONTROL_FLAGS->output_dir + "\n";
+    flags += GLOBAL_CONTROL_FLAGS->template_include + "\n";
+    flags += GLOBAL_CONTROL_FLAGS->emitter + "\n";
+    flags += std::format("{}\n", GLOBAL_CONTROL_FLAGS->parse_function_bodies);
+    for (const std::string& link_target : GLOBAL_CONTROL_FLAGS->link_targets) {
+        flags += link_target + "\n";
+    }
+    flags += text::RTTI;
+    flags += text::GENERATED_TEMPLATE_HEADER_TEMPLATE;
+    flags += text::REFLECTED_METADATA;
+    return FNV1aHash{}(flags);
+}
+
+zeno::reflect::GenerationCache::GenerationCache(std::string cache_path, size_t flags_hash)
+    : m_cache_path(std::move(cache_path))
+    , m_flags_hash(flags_hash)
+{
+}
+
+void zeno::reflect::GenerationCache::load()
+{
+    std::optional<std::string> content = read_file(m_cache_path);
+    if (!content.has_value()) {
+        return;
+    }
+
+    inja::json root = inja::json::parse(content.value(), nullptr, false);
+    if (root.is_discarded() || !root.is_object()) {
+        ZENO_REFLECTION_LOG_DEBUG("[debug] Ignoring corrupted reflection cache \"{}\"", m_cache_path);
+        return;
+    }
+    if (root.value("version", 0) != REFLECTION_CACHE_VERSION || root.value("flags", size_t(0)) != m_flags_hash) {
+        ZENO_REFLECTION_LOG_DEBUG("[debug] Generator flags changed, dropping reflection cache \"{}\"", m_cache_path);
+        return;
+    }
+
+    std::error_code err;
+    const auto saved_at = std::filesystem::last_write_time(m_cache_path, err);
+    try {
+        for (const auto& [path, stamp] : root.value("files", inja::json::object()).items()) {
+            FileStamp file_stamp {
+                .mtime = stamp.at(0).get<std::filesystem::file_time_type::rep>(),
+                .size = stamp.at(1).get<uintmax_t>(),
+                .hash = stamp.at(2).get<size_t>(),
+            };
+            const std::filesystem::file_time_type mtime { std::filesystem::file_time_type::duration(file_stamp.mtime) };
+            if (!err && mtime + STAMP_RESOLUTION < saved_at) {
+                m_files.insert_or_assign(path, file_stamp);
+            }
+        }
+    } catch (const inja::json::exception& e) {
+        ZENO_REFLECTION_LOG_DEBUG("[debug] Ignoring file stamps of reflection cache: {}", e.what());
+        m_files.clear();
+    }
+    m_headers = root.value("headers", inja::json::object());
+}
+
+bool zeno::reflect::GenerationCache::save()
+{
+    // Only keep stamps of files still referenced by a cached header
+    inja::json files = inja::json::object();
+    for (const auto& [identity_name, entry] : m_headers.items()) {
+        for (const auto& dependency : entry.value("dependencies", inja::json::array())) {
+            const std::string path = dependency.get<std::string>();
+            if (auto it = m_files.find(path); it != m_files.end()) {
+                files[path] = inja::json::array({ it->second.mtime, it->second.size, it->second.hash });
+            }
+        }
+    }
+
+    inja::json root;
+    root["version"] = REFLECTION_CACHE_VERSION;
+    root["flags"] = m_flags_hash;
+    root["files"] = std::move(files);
+    root["headers"] = m_headers;
+
+    mkdirs(std::filesystem::path(m_cache_path).parent_path().string());
+    return write_file_atomically(m_cache_path, root.dump());
+}
+
+std::optional<HeaderReflectionResult> zeno::reflect::GenerationCache::find(const std::string& identity_name)
+{
+    auto it = m_headers.find(identity_name);
+    if (it == m_headers.end()) {
+        return std::nullopt;
+    }
+
+    try {
+        const inja::json& entry = *it;
+        std::vector<std::string> dependencies = entry.at("dependencies").get<std::vector<std::string>>();
+        const std::optional<size_t> key = compute_key(dependencies);
+        if (!key.has_value() || key.value() != entry.at("key").get<size_t>()) {
+            return std::nullopt;
+        }
+
+        HeaderReflectionResult result;
+        result.identity_name = identity_name;
+        result.generated_header_path = entry.at("generated_header_path").get<std::string>();
+        for (const auto& block : entry.at("rtti_blocks")) {
+            result.rtti_blocks.push_back({ block.at(0).get<size_t>(), block.at(1).get<std::string>() });
+        }
+        result.types = entry.at("types").get<std::vector<ReflectedType>>();
+        result.dependencies = std::move(dependencies);
+        return result;
+    } catch (const inja::json::exception& e) {
+        ZENO_REFLECTION_LOG_DEBUG("[debug] Ignoring corrupted cache entry of \"{}\": {}", identity_name, e.what());
+        return std::nullopt;
+    }
+}
+
+void zeno::reflect::GenerationCache::store(const HeaderReflectionResult& result)
+{
+    const std::optional<size_t> key = compute_key(result.dependencies);
+    if (!key.has_value()) {
+        m_headers.erase(result.identity_name);
+        return;
+    }
+
+    inja::json rtti_blocks = inja::json::array();
+    for (const GeneratedRTTIBlock& block : result.rtti_blocks) {
+        rtti_blocks.push_back(inja::json::array({ block.hash, block.code }));
+    }
+
+    inja::json entry;
+    entry["key"] = key.value();
+    entry["generated_header_path"] = result.generated_header_path;
+    entry["dependencies"] = result.dependencies;
+    entry["rtti_blocks"] = std::move(rtti_blocks);
+    entry["types"] = result.types;
+    m_headers[result.identity_name] = std::move(entry);
+}
+
+std::optional<size_t> zeno::reflect::GenerationCache::get_file_hash(const std::string& path)
+{
+    std::error_code err;
+    const uintmax_t size = std::filesystem::file_size(path, err);
+    if (err) {
+        return std::nullopt;
+    }
+    const auto mtime = std::filesystem::last_write_time(path, err).time_since_epoch().count();
+    if (err) {
+        return std::nullopt;
+    }
+
+    if (auto it = m_files.find(path); it != m_files.end() && it->second.size == size && it->second.mtime == mtime) {
+        return it->second.hash;
+    }
+
+    std::optional<std::string> content = read_file(path);
+    if (!content.has_value()) {
+        return std::nullopt;
+    }
+    const size_t hash = FNV1aHash{}(content.value());
+    m_files.insert_or_assign(path, FileStamp { .mtime = mtime, .size = size, .hash = hash });
+    return hash;
+}
+
+std::optional<size_t> zeno::reflect::GenerationCache::compute_key(const std::vector<std::string>& dependencies)
+{
+    std::string key_source;
+    for (const std::string& dependency : dependencies) {
+        const std::optional<size_t> hash = get_file_hash(dependency);
+        if (!hash.has_value()) {
+            return std::nullopt;
+        }
+        key_source += std::format("{}:{:016x}\n", dependency, hash.value());
+    }
+    return FNV1aHash{}(key_source);
+}
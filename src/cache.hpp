@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <filesystem>
+#include "inja/inja.hpp"
+#include "parser.hpp"
+
+namespace zeno
+{
+namespace reflect
+{
+    /**
+     * Hash of everything besides the headers themselves that affects generated code:
+     * parser arguments, output locations and the built-in templates.
+    */
+    size_t compute_generation_flags_hash();
+
+    /**
+     * Persistent per-target store of header results.
+     * A cached result is valid as long as the content of every file it depends on and the generator flags are unchanged.
+     *
+     * Results must be context free (parsed with a fresh CodeCompilerState), otherwise they would miss RTTI
+     * and records that another header happened to claim first in the run they were produced.
+    */
+    class GenerationCache {
+    public:
+        GenerationCache(std::string cache_path, size_t flags_hash);
+
+        void load();
+        bool save();
+
+        std::optional<HeaderReflectionResult> find(const std::string& identity_name);
+        void store(const HeaderReflectionResult& result);
+
+    private:
+        struct FileStamp {
+            std::filesystem::file_time_type::rep mtime = 0;
+            uintmax_t size = 0;
+            size_t hash = 0;
+        };
+
+        std::optional<size_t> get_file_hash(const std::string& path);
+        std::optional<size_t> compute_key(const std::vector<std::string>& dependencies);
+
+        std::string m_cache_path;
+        size_t m_flags_hash;
+        inja::json m_headers = inja::json::object();
+        std::unordered_map<std::string, FileStamp> m_files;
+    };
+}
+}
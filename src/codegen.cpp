@@ -14,10 +14,24 @@ std::string zeno::reflect::TemplateHeaderGenerator::compile()
 
 std::string zeno::reflect::TemplateHeaderGenerator::compile(CodeCompilerState &state)
 {
-    inja::json template_data;
-    template_data["rttiBlock"] = m_rtti_block.str();
-    template_data["template_include"] = state.types_register_data["template_include"];
-    return inja::render(text::GENERATED_TEMPLATE_HEADER_TEMPLATE, template_data);
+    std::string rtti_block;
+    for (const GeneratedRTTIBlock& block : m_rtti_blocks) {
+        rtti_block += block.code;
+    }
+
+    return emit_generated_template_header(rtti_block, state.type_register_data.template_include);
+}
+
+std::vector<GeneratedRTTIBlock> zeno::reflect::TemplateHeaderGenerator::take_rtti_blocks()
+{
+    return std::move(m_rtti_blocks);
+}
+
+void zeno::reflect::TemplateHeaderGenerator::add_compiled_rtti_block(GeneratedRTTIBlock block)
+{
+    if (!block.code.empty()) {
+        m_rtti_blocks.push_back(std::move(block));
+    }
 }
 
 zeno::reflect::ForwardDeclarationGenerator::ForwardDeclarationGenerator(const clang::QualType &qual_type)
@@ -81,9 +95,8 @@ std::string zeno::reflect::ForwardDeclarationGenerator::compile(CodeCompilerStat
 zeno::reflect::CodeCompilerState::CodeCompilerState(ReflectionASTConsumer* in_consumer)
     : m_consumer(in_consumer)
 {
-    types_register_data["types"] = std::vector<inja::json>{};
-    types_register_data["prefix"] = "";
-    types_register_data["headers"] = GLOBAL_CONTROL_FLAGS->input_sources;
-    types_register_data["template_include"] = GLOBAL_CONTROL_FLAGS->template_include;
+    type_register_data.prefix = "";
+    type_register_data.headers = GLOBAL_CONTROL_FLAGS->input_sources;
+    type_register_data.template_include = GLOBAL_CONTROL_FLAGS->template_include;
     inja_dir = GLOBAL_CONTROL_FLAGS->inja_dir;
 }
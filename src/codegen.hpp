@@ -3,6 +3,7 @@
 #include <string>
 #include <concepts>
 #include <utility>
+#include <unordered_set>
 #include "clang/AST/Type.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
@@ -10,8 +11,10 @@
 #include "clang/AST/DeclCXX.h"
 #include "inja/inja.hpp"
 #include "template/template_literal"
+#include "emitter.hpp"
 #include "utils.hpp"
 #include "args.hpp"
+#include "log.hpp"
 #include "parser.hpp"
 
 class ReflectionASTConsumer;
@@ -19,8 +22,15 @@ class ReflectionASTConsumer;
 namespace zeno::reflect
 {
     struct CodeCompilerState {
-        std::unordered_map<size_t, uint8_t> type_hash_flag;
-        inja::json types_register_data;
+        /// RTTI code of unnamed types generated with this state keyed by type hash, every header needing a type gets the same code
+        std::unordered_map<size_t, std::string> rtti_block_code;
+        /// `normal_name` of every type merged so far, types themselves are handed to the register stream
+        std::unordered_set<std::string> registered_type_names;
+        /// Per-header generated header defining each RTTI block merged so far, keyed by type hash
+        std::unordered_map<size_t, std::string> rtti_block_headers;
+        /// Per-header generated headers in merge order, the target RTTI header includes them in this order
+        std::vector<std::string> rtti_headers;
+        TypeRegisterData type_register_data;
         std::string inja_dir;
         ReflectionASTConsumer* m_consumer;
 
@@ -58,8 +68,12 @@ namespace zeno::reflect
             m_qual_type = m_qual_type->getCanonicalTypeUnqualified();
         }
 
-        std::string compile(CodeCompilerState& state, const std::string& dispName = "", bool hasConstMark = false) {
-            const size_t hash_value = HashImpl{}(m_qual_type.getAsString());
+        size_t hash() const {
+            return HashImpl{}(m_qual_type.getAsString());
+        }
+
+        std::string compile(CodeCompilerState& state, const std::string& dispName = "") {
+            const size_t hash_value = hash();
             std::string cppType = m_qual_type.getAsString();
             std::string name = m_qual_type.getCanonicalType().getAsString();
             if (cppType.find("_Bool") != std::string::npos) {
@@ -67,33 +81,45 @@ namespace zeno::reflect
                 replace_all(name, "_Bool", "bool");
             }
             if (is_blacklisted_keyword(cppType)) {
-                if (GLOBAL_CONTROL_FLAGS->verbose) {
-                    llvm::outs() << "[debug] Skipping compiler internal type \"" << cppType << "\"\n";
-                }
+                ZENO_REFLECTION_LOG_DEBUG("[debug] Skipping compiler internal type \"{}\"", cppType);
                 return "";
             }
-            if (state.type_hash_flag.contains(hash_value)) {
-                return "";
+            // Named blocks carry a constant of their own and are never shared
+            if (auto it = state.rtti_block_code.find(hash_value); dispName.empty() && it != state.rtti_block_code.end()) {
+                return it->second;
+            }
+
+            RTTIBlockData data;
+            data.forward_decl = ForwordDeclGenerator(m_qual_type).compile(state);
+            data.cpp_type = cppType;
+            data.name_normalized = zeno::reflect::convert_to_valid_cpp_var_name(cppType);
+            data.name = name;
+            data.disp_name = dispName;
+            data.hash = hash_value;
+            data.is_pointer = m_qual_type->isPointerType();
+            data.is_rvalue_ref = m_qual_type->isRValueReferenceType();
+            data.is_lvalue_ref = m_qual_type->isLValueReferenceType();
+            data.is_const = m_qual_type.isConstQualified();
+            std::string code = emit_rtti_block(data);
+            if (dispName.empty()) {
+                state.rtti_block_code.emplace(hash_value, code);
+            }
+            return code;
+        }
+
+        /**
+         * Only the `gParamType_<dispName>` constant of the type, for types whose RTTI libreflect derives.
+         * Specializing their type_info would define it differently in the TUs which don't include the generated header.
+        */
+        std::string compile_type_name(const std::string& dispName) {
+            std::string cppType = m_qual_type.getAsString();
+            if (cppType.find("_Bool") != std::string::npos) {
+                replace_all(cppType, "_Bool", "bool");
             }
-            state.type_hash_flag.insert_or_assign(hash_value, 1);
-
-            inja::json data;
-
-            const std::string forward_decl = ForwordDeclGenerator(m_qual_type).compile(state);
-            data["forwordDecl"] = forward_decl;
-            data["cppType"] = cppType;
-            data["name_normalized"] = zeno::reflect::convert_to_valid_cpp_var_name(cppType);
-            data["name"] = name;
-            data["dispName"] = dispName;
-            data["hash"] = hash_value;
-            data["isPointer"] = m_qual_type->isPointerType();
-            data["isRValueRef"] = m_qual_type->isRValueReferenceType();
-            data["isLValueRef"] = m_qual_type->isLValueReferenceType();
-            data["isConst"] = m_qual_type.isConstQualified();
-            if (hasConstMark) {
-                data["isConst"] = true;
+            if (is_blacklisted_keyword(cppType)) {
+                return "";
             }
-            return inja::render(text::RTTI, data);
+            return emit_type_name_block(cppType, dispName, hash());
         }
 
         static inline bool is_blacklisted_keyword(std::string_view keyword) {
@@ -107,7 +133,7 @@ namespace zeno::reflect
 
     class TemplateHeaderGenerator {
         CodeCompilerState& m_compiler_state;
-        std::stringstream m_rtti_block{};
+        std::vector<GeneratedRTTIBlock> m_rtti_blocks{};
 
     public:
         TemplateHeaderGenerator(CodeCompilerState& state);
@@ -115,18 +141,54 @@ namespace zeno::reflect
         std::string compile();
         std::string compile(CodeCompilerState& state);
 
+        /**
+         * Move the compiled RTTI blocks out of the generator, keeping their emission order.
+        */
+        std::vector<GeneratedRTTIBlock> take_rtti_blocks();
+
+        void add_compiled_rtti_block(GeneratedRTTIBlock block);
+
         template <ICodeCompiler T>
         void add_rtti_block(T generator) {
-            m_rtti_block << generator.compile(m_compiler_state);
+            // Blocks without a type hash are never de-duplicated when merging
+            add_compiled_rtti_block({ 0, generator.compile(m_compiler_state) });
+        }
+
+        /**
+         * Generate the RTTI of the type `type` is built on.
+         * References, cv-qualifiers and pointers are stripped, libreflect derives the RTTI of those variants from the base type.
+         * Function pointers are kept as they are, a function type has no RTTI of its own.
+         * A display name belongs to `type` itself, a named pointer type only gets its name constant.
+        */
+        void add_rtti_type(clang::QualType type, const std::string& dispName = "") {
+            const clang::QualType registered_type = type.getCanonicalType().getNonReferenceType().getUnqualifiedType();
+            clang::QualType base_type = registered_type;
+            while (base_type->isPointerType() && !base_type->isFunctionPointerType()) {
+                base_type = base_type->getPointeeType().getUnqualifiedType();
+            }
+
+            if (base_type == registered_type) {
+                add_rtti_type_block(base_type, dispName);
+                return;
+            }
+            add_rtti_type_block(base_type, "");
+            if (!dispName.empty()) {
+                // Merged once like an RTTI block, no RTTI block has the hash of a pointer type
+                RTTITypeGenerator<> generator(registered_type);
+                m_rtti_blocks.push_back({ generator.hash(), generator.compile_type_name(dispName) });
+            }
         }
 
-        template <ICodeCompiler T = RTTITypeGenerator<>>
-        void add_rtti_type(clang::QualType type, const std::string& dispName = "", bool bHasConstMark = false) {
+    private:
+        void add_rtti_type_block(clang::QualType type, const std::string& dispName) {
+            // libreflect specializes these itself
             const auto& typeStr = type.getAsString();
-            if (typeStr == "void" || typeStr == "void *" || typeStr == "void &" || typeStr == "const void &" || typeStr == "void &&" || typeStr == "std::nullptr_t") {
+            if (typeStr == "void" || typeStr == "std::nullptr_t") {
                 return;
             }
-            m_rtti_block << RTTITypeGenerator(type).compile(m_compiler_state, dispName, bHasConstMark);
+            // Every header gets the code, merging keeps it in the generated header of the first header using the type
+            RTTITypeGenerator<> generator(type);
+            m_rtti_blocks.push_back({ generator.hash(), generator.compile(m_compiler_state, dispName) });
         }
     };
 }
@@ -0,0 +1,206 @@
+#include <mutex>
+#include "driver.hpp"
+#include "args.hpp"
+#include "log.hpp"
+#include "utils.hpp"
+#include "cache.hpp"
+#include "codegen.hpp"
+#include "emitter.hpp"
+#include "parser.hpp"
+#include "prescan.hpp"
+#include "profiler.hpp"
+
+int32_t zeno::reflect::run_reflection_generator(std::set<std::string>* out_dependencies)
+{
+    if (!zeno::reflect::parse_emitter_backend(GLOBAL_CONTROL_FLAGS->emitter).has_value()) {
+        std::cerr << std::format("Unknown emitter backend {}, expected inja or native", GLOBAL_CONTROL_FLAGS->emitter) << std::endl;
+        return 2;
+    }
+
+    const auto total_begin = zeno::reflect::ProfileClock::now();
+    zeno::reflect::reset_output_write_summary();
+    ReflectionModel model{};
+    pre_generate_reflection_model();
+
+    std::vector<TranslationUnit> units;
+    for (const std::string& filepath : GLOBAL_CONTROL_FLAGS->input_sources) {
+        std::optional<std::string> source_str = zeno::reflect::read_file(filepath);
+        if (!source_str.has_value()) {
+            std::cerr << std::format("Can't read source file {}", filepath) << std::endl;
+            return 2;
+        }
+
+        units.push_back({
+            .identity_name = filepath,
+            .source = std::move(source_str.value()),
+            .type = TranslationUnitType::Header,
+        });
+    }
+
+    std::optional<zeno::reflect::GenerationCache> cache;
+    if (GLOBAL_CONTROL_FLAGS->incremental) {
+        zeno::reflect::ProfileScope cache_scope("cache_load");
+        const std::string cache_path = (std::filesystem::path(zeno::reflect::get_cache_dir()) / std::format("{}.reflection_cache.json", GLOBAL_CONTROL_FLAGS->target_name)).string();
+        cache.emplace(cache_path, zeno::reflect::compute_generation_flags_hash());
+        cache->load();
+    }
+
+    // Headers which have to go through clang
+    std::vector<HeaderReflectionResult> results(units.size());
+    std::vector<size_t> pending_units;
+    size_t prescan_skipped = 0;
+    zeno::reflect::ReflectionMarkerPrescan prescan(GLOBAL_CONTROL_FLAGS->include_dirs);
+    for (size_t i = 0; i < units.size(); ++i) {
+        if (!GLOBAL_CONTROL_FLAGS->no_prescan) {
+            zeno::reflect::ProfileScope prescan_scope("prescan", units[i].identity_name);
+            std::set<std::string> scanned_files;
+            if (!prescan.has_reflection_markers(units[i].identity_name, units[i].source, scanned_files)) {
+                prepare_skipped_reflection_result(units[i], scanned_files, results[i]);
+                ++prescan_skipped;
+                continue;
+            }
+        }
+        if (cache.has_value()) {
+            if (std::optional<HeaderReflectionResult> cached_result = cache->find(units[i].identity_name)) {
+                results[i] = std::move(cached_result.value());
+                continue;
+            }
+        }
+        pending_units.push_back(i);
+    }
+    if (cache.has_value()) {
+        ZENO_REFLECTION_LOG_DEBUG("[debug] {} of {} headers served from the reflection cache", units.size() - prescan_skipped - pending_units.size(), units.size());
+    }
+
+    const uint32_t jobs = zeno::reflect::resolve_job_count(GLOBAL_CONTROL_FLAGS->jobs);
+
+    // Each worker owns its compiler state, the root state only sees merged results
+    std::vector<std::unique_ptr<zeno::reflect::CodeCompilerState>> worker_states;
+    for (uint32_t i = 0; i < jobs; ++i) {
+        worker_states.push_back(std::make_unique<zeno::reflect::CodeCompilerState>(nullptr));
+    }
+
+    // Results are merged in input order as soon as they and every result before them are ready, and dropped afterwards.
+    // Merging hands the types to the register stream, so only results of headers finished out of order are held at once.
+    zeno::reflect::CodeCompilerState compiler_state {nullptr};
+    // Spelled through the include dirs, the register sources don't change with where the tree is checked out
+    for (std::string& header : compiler_state.type_register_data.headers) {
+        header = zeno::reflect::relative_path_to_include_dirs(header, GLOBAL_CONTROL_FLAGS->include_dirs);
+    }
+    zeno::reflect::TypeRegisterStream register_stream(
+        GLOBAL_CONTROL_FLAGS->target_type_register_source_path,
+        compiler_state.type_register_data,
+        compiler_state.inja_dir,
+        static_cast<uint32_t>(std::max(GLOBAL_CONTROL_FLAGS->shards, 1))
+    );
+    std::mutex merge_mutex;
+    std::vector<uint8_t> ready_units(units.size(), 1);
+    std::vector<uint8_t> cacheable_units(units.size(), 0);
+    for (size_t unit_index : pending_units) {
+        ready_units[unit_index] = 0;
+    }
+    size_t next_merged_unit = 0;
+    int32_t result = 0;
+    // Callers hold merge_mutex
+    auto merge_ready_results = [&]() {
+        while (next_merged_unit < results.size() && ready_units[next_merged_unit]) {
+            HeaderReflectionResult& header_result = results[next_merged_unit];
+            if (cache.has_value() && cacheable_units[next_merged_unit]) {
+                cache->store(header_result);
+            }
+            result += static_cast<int32_t>(merge_reflection_result(header_result, model, compiler_state, register_stream));
+            header_result = HeaderReflectionResult{};
+            ++next_merged_unit;
+        }
+    };
+    {
+        // Cached and skipped headers in front of the first parsed one
+        std::lock_guard lock(merge_mutex);
+        merge_ready_results();
+    }
+
+    std::vector<int32_t> error_codes;
+    if (GLOBAL_CONTROL_FLAGS->batch && !cache.has_value()) {
+        // Only headers left by the pre-scan are batched, their results go back to their input position afterwards
+        std::vector<TranslationUnit> batch_units;
+        std::vector<HeaderReflectionResult> batch_results(pending_units.size());
+        for (size_t unit_index : pending_units) {
+            batch_units.push_back(std::move(units[unit_index]));
+        }
+
+        // Each unit of a batch gets the declarations of every header it includes, so the split into batches doesn't change
+        // what a unit contributes, and merging in input order writes the same outputs as a serial run
+        const size_t batch_count = std::min<size_t>(jobs, batch_units.size());
+        error_codes.resize(batch_count, 0);
+        zeno::reflect::parallel_for(batch_count, jobs, [&](size_t batch, uint32_t worker_id) {
+            const size_t begin = batch_units.size() * batch / batch_count;
+            const size_t end = batch_units.size() * (batch + 1) / batch_count;
+            error_codes[batch] = static_cast<int32_t>(generate_reflection_model_batched(
+                std::span<const TranslationUnit>(batch_units).subspan(begin, end - begin),
+                std::span<HeaderReflectionResult>(batch_results).subspan(begin, end - begin),
+                *worker_states[worker_id],
+                get_parse_session(worker_id)
+            ));
+
+            std::lock_guard lock(merge_mutex);
+            for (size_t index = begin; index < end; ++index) {
+                results[pending_units[index]] = std::move(batch_results[index]);
+                ready_units[pending_units[index]] = 1;
+            }
+            merge_ready_results();
+        });
+    } else {
+        // Cached results must not depend on which header claimed a type first, so each header gets a fresh state then.
+        // This is also why batching is skipped in incremental mode.
+        error_codes.resize(pending_units.size(), 0);
+        zeno::reflect::parallel_for(pending_units.size(), jobs, [&](size_t index, uint32_t worker_id) {
+            const size_t unit_index = pending_units[index];
+            if (cache.has_value()) {
+                zeno::reflect::CodeCompilerState header_state {nullptr};
+                error_codes[index] = static_cast<int32_t>(generate_reflection_model(units[unit_index], results[unit_index], header_state, get_parse_session(worker_id)));
+            } else {
+                error_codes[index] = static_cast<int32_t>(generate_reflection_model(units[unit_index], results[unit_index], *worker_states[worker_id], get_parse_session(worker_id)));
+            }
+            // The parse session keeps its own copy of the source
+            std::string().swap(units[unit_index].source);
+
+            std::lock_guard lock(merge_mutex);
+            cacheable_units[unit_index] = error_codes[index] == static_cast<int32_t>(ParserErrorCode::Success);
+            ready_units[unit_index] = 1;
+            merge_ready_results();
+        });
+    }
+
+    for (int32_t error_code : error_codes) {
+        result += error_code;
+    }
+
+    if (cache.has_value()) {
+        zeno::reflect::ProfileScope cache_scope("cache_save");
+        if (!cache->save()) {
+            std::cerr << "Failed to save the reflection cache" << std::endl;
+        }
+    }
+
+    result += static_cast<int32_t>(post_generate_reflection_model(model, compiler_state, register_stream));
+    if (nullptr != out_dependencies) {
+        out_dependencies->insert(model.dependencies.begin(), model.dependencies.end());
+    }
+
+    const zeno::reflect::OutputWriteSummary write_summary = zeno::reflect::get_output_write_summary();
+    std::cout << std::format("[{}] Reflection outputs: {} updated, {} unchanged", GLOBAL_CONTROL_FLAGS->target_name, write_summary.written, write_summary.unchanged);
+    if (write_summary.failed > 0) {
+        std::cout << std::format(", {} failed", write_summary.failed);
+    }
+    if (prescan_skipped > 0) {
+        std::cout << std::format(", {} of {} headers skipped without reflection macros", prescan_skipped, units.size());
+    }
+    std::cout << std::endl;
+
+    zeno::reflect::record_profile_event("total", GLOBAL_CONTROL_FLAGS->target_name, total_begin, zeno::reflect::ProfileClock::now());
+    if (!zeno::reflect::write_profile_outputs()) {
+        ++result;
+    }
+
+    return result;
+}
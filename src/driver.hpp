@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <string>
+
+namespace zeno
+{
+namespace reflect
+{
+    /**
+     * Run one generation with the options in GLOBAL_CONTROL_FLAGS, from reading the input sources to printing the output summary.
+     * Returns the summed error codes, 0 on success.
+     * Called once by a plain invocation, once per request by a resident `--serve` process and once per target of a `--manifest`.
+     * The files the outputs depend on are added to `out_dependencies` if given.
+    */
+    int32_t run_reflection_generator(std::set<std::string>* out_dependencies = nullptr);
+}
+}
@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include "emitter.hpp"
+#include "args.hpp"
+#include "log.hpp"
+#include "utils.hpp"
+#include "profiler.hpp"
+#include "register_template.hpp"
+#include "template_library.hpp"
+
+namespace
+{
+    /// Rough size of the wrappers emitted for `type`, used to balance register source shards
+    size_t estimate_register_cost(const ReflectedType& type)
+    {
+        size_t cost = 4 + type.base_classes.size();
+        for (const ReflectedConstructor& ctor : type.ctors) {
+            cost += 4 + 2 * ctor.params.size();
+        }
+        for (const ReflectedFunction& func : type.funcs) {
+            cost += 8 + 4 * func.params.size();
+        }
+        cost += 3 * type.fields.size();
+        return cost;
+    }
+
+    std::string get_register_template_path(const std::string& inja_dir)
+    {
+        return inja_dir + "/" + "reflected_type_register.inja";
+    }
+
+    /// Everything but the types, which the prelude and the epilogue of a split register template don't use
+    inja::json make_shared_register_json(const TypeRegisterData& data)
+    {
+        TypeRegisterData shared_data;
+        shared_data.prefix = data.prefix;
+        shared_data.headers = data.headers;
+        shared_data.template_include = data.template_include;
+        return inja::json(shared_data);
+    }
+
+    /// Number of types whose sections are rendered together, enough to keep every worker busy
+    size_t get_register_render_window()
+    {
+        return std::max<size_t>(resolve_job_count(GLOBAL_CONTROL_FLAGS->jobs) * 16, 1);
+    }
+
+    /**
+     * Sections of `types` rendered from `split` on --jobs workers into `out_sections`, in the order of `types`.
+     * Returns false if a type fails to render.
+    */
+    bool render_type_sections(const SplitRegisterTemplate& split, const inja::json& shared_json, const std::vector<const ReflectedType*>& types, std::vector<std::string>& out_sections)
+    {
+        TemplateLibrary& template_library = TemplateLibrary::get();
+        const uint32_t jobs = resolve_job_count(GLOBAL_CONTROL_FLAGS->jobs);
+        // Each worker reuses its copy of the shared data, only the single type changes
+        std::vector<inja::json> worker_json(jobs, shared_json);
+        out_sections.assign(types.size(), std::string());
+        std::atomic_bool failed = false;
+        parallel_for(types.size(), jobs, [&](size_t index, uint32_t worker_id) {
+            const ReflectedType& type = *types[index];
+            try {
+                worker_json[worker_id]["types"] = inja::json::array({ inja::json(type) });
+                out_sections[index] = template_library.render(split.type_section, worker_json[worker_id]);
+            } catch (const std::exception& e) {
+                std::cerr << std::format("Failed to render the register code of {}: {}", type.qualified_name, e.what()) << std::endl;
+                failed = true;
+            }
+        });
+        return !failed;
+    }
+
+    /**
+     * Render the register source with the sections of the types rendered on --jobs workers.
+     * Types are rendered a window at a time and written in order, so the output equals a single render of the whole template.
+    */
+    bool render_register_template_parallel(std::ostream& out, const SplitRegisterTemplate& split, const TypeRegisterData& data)
+    {
+        TemplateLibrary& template_library = TemplateLibrary::get();
+        const inja::json shared_json = make_shared_register_json(data);
+        template_library.render_to(out, split.prelude, shared_json);
+
+        const size_t window = get_register_render_window();
+        std::vector<const ReflectedType*> window_types;
+        std::vector<std::string> sections;
+        for (size_t window_begin = 0; window_begin < data.types.size(); window_begin += window) {
+            window_types.clear();
+            for (size_t i = window_begin; i < std::min(window_begin + window, data.types.size()); ++i) {
+                window_types.push_back(&data.types[i]);
+            }
+            if (!render_type_sections(split, shared_json, window_types, sections)) {
+                return false;
+            }
+            for (const std::string& section : sections) {
+                out << section;
+            }
+        }
+
+        template_library.render_to(out, split.epilogue, shared_json);
+        return true;
+    }
+
+    /// Index of the lightest shard in `loads`, which then carries `type` as well. The first one wins ties.
+    size_t assign_register_shard(std::vector<size_t>& loads, const ReflectedType& type)
+    {
+        const size_t shard = std::min_element(loads.begin(), loads.end()) - loads.begin();
+        loads[shard] += estimate_register_cost(type);
+        return shard;
+    }
+}
+
+std::optional<zeno::reflect::EmitterBackend> zeno::reflect::parse_emitter_backend(std::string_view name)
+{
+    if (name == "inja") {
+        return EmitterBackend::Inja;
+    }
+    if (name == "native") {
+        return EmitterBackend::Native;
+    }
+    return std::nullopt;
+}
+
+zeno::reflect::EmitterBackend zeno::reflect::get_emitter_backend()
+{
+    return parse_emitter_backend(GLOBAL_CONTROL_FLAGS->emitter).value_or(EmitterBackend::Inja);
+}
+
+std::string zeno::reflect::emit_rtti_block(const RTTIBlockData& data)
+{
+    if (get_emitter_backend() == EmitterBackend::Native) {
+        return emit_rtti_block_native(data);
+    }
+
+    inja::json template_data;
+    template_data["forwordDecl"] = data.forward_decl;
+    template_data["cppType"] = data.cpp_type;
+    template_data["name_normalized"] = data.name_normalized;
+    template_data["name"] = data.name;
+    template_data["dispName"] = data.disp_name;
+    template_data["hash"] = data.hash;
+    template_data["isPointer"] = data.is_pointer;
+    template_data["isRValueRef"] = data.is_rvalue_ref;
+    template_data["isLValueRef"] = data.is_lvalue_ref;
+    template_data["isConst"] = data.is_const;
+    return TemplateLibrary::get().render(TemplateLibrary::get().rtti(), template_data);
+}
+
+std::string zeno::reflect::emit_type_name_block(std::string_view cpp_type, std::string_view disp_name, size_t hash)
+{
+    if (get_emitter_backend() == EmitterBackend::Native) {
+        return emit_type_name_block_native(cpp_type, disp_name, hash);
+    }
+
+    inja::json template_data;
+    template_data["cppType"] = cpp_type;
+    template_data["dispName"] = disp_name;
+    template_data["hash"] = hash;
+    return TemplateLibrary::get().render(TemplateLibrary::get().type_name(), template_data);
+}
+
+std::string zeno::reflect::emit_generated_template_header(std::string_view rtti_block, std::string_view template_include)
+{
+    if (get_emitter_backend() == EmitterBackend::Native) {
+        return emit_generated_template_header_native(rtti_block, template_include);
+    }
+
+    inja::json template_data;
+    template_data["rttiBlock"] = rtti_block;
+    template_data["template_include"] = template_include;
+    return TemplateLibrary::get().render(TemplateLibrary::get().generated_template_header(), template_data);
+}
+
+ParserErrorCode zeno::reflect::emit_type_register_source(const std::string& path, const TypeRegisterData& data, const std::string& inja_dir)
+{
+    StreamingFileWriter writer(path);
+    {
+        // Rendering streams into the temporary file, only the final compare and rename count as write
+        ProfileScope render_scope("render", path);
+        if (get_emitter_backend() == EmitterBackend::Native) {
+            TypeRegisterWriter(writer.stream(), data).write();
+        } else {
+            const std::string template_path = get_register_template_path(inja_dir);
+            TemplateLibrary& template_library = TemplateLibrary::get();
+            const TemplateLibrary::FileTemplate* register_template = template_library.get_file_template(template_path);
+            if (nullptr == register_template) {
+                return ParserErrorCode::TUCreationFailure;
+            }
+            std::optional<SplitRegisterTemplate> split = split_register_template(*register_template->tmpl);
+            if (split.has_value()) {
+                if (!render_register_template_parallel(writer.stream(), split.value(), data)) {
+                    return ParserErrorCode::TUCreationFailure;
+                }
+            } else {
+                ZENO_REFLECTION_LOG_DEBUG("[debug] {} can't be rendered per type, rendering it at once", template_path);
+                template_library.render_to(writer.stream(), *register_template, inja::json(data));
+            }
+        }
+    }
+
+    if (writer.commit() == FileWriteResult::Failed) {
+        std::cerr << std::format("Failed to write {}", path) << std::endl;
+        return ParserErrorCode::InternalError;
+    }
+    return ParserErrorCode::Success;
+}
+
+std::string zeno::reflect::get_register_source_shard_path(const std::string& path, uint32_t shard)
+{
+    const std::filesystem::path source_path(path);
+    return (source_path.parent_path() / std::format("{}.{}{}", source_path.stem().string(), shard, source_path.extension().string())).string();
+}
+
+std::vector<std::vector<size_t>> zeno::reflect::partition_register_types(const std::vector<ReflectedType>& types, uint32_t shards)
+{
+    std::vector<std::vector<size_t>> result(std::max<uint32_t>(shards, 1));
+
+    // Same online assignment as TypeRegisterStream, which never sees the types coming after the current one
+    std::vector<size_t> loads(result.size(), 0);
+    for (size_t i = 0; i < types.size(); ++i) {
+        result[assign_register_shard(loads, types[i])].push_back(i);
+    }
+    return result;
+}
+
+ParserErrorCode zeno::reflect::emit_type_register_sources(const std::string& path, const TypeRegisterData& data, const std::string& inja_dir, uint32_t shards)
+{
+    if (shards <= 1) {
+        return emit_type_register_source(path, data, inja_dir);
+    }
+
+    const std::vector<std::vector<size_t>> partition = partition_register_types(data.types, shards);
+    ParserErrorCode result = ParserErrorCode::Success;
+    for (uint32_t shard = 0; shard < partition.size(); ++shard) {
+        TypeRegisterData shard_data;
+        shard_data.prefix = data.prefix;
+        shard_data.headers = data.headers;
+        shard_data.template_include = data.template_include;
+        for (size_t index : partition[shard]) {
+            shard_data.types.push_back(data.types[index]);
+        }
+        // Every shard is written, even an empty one, since the build system expects all of them
+        const ParserErrorCode shard_result = emit_type_register_source(get_register_source_shard_path(path, shard), shard_data, inja_dir);
+        if (shard_result != ParserErrorCode::Success) {
+            result = shard_result;
+        }
+    }
+    return result;
+}
+
+zeno::reflect::TypeRegisterStream::TypeRegisterStream(std::string path, TypeRegisterData data, std::string inja_dir, uint32_t shards)
+    : m_path(std::move(path))
+    , m_data(std::move(data))
+    , m_inja_dir(std::move(inja_dir))
+    , m_shards(std::max<uint32_t>(shards, 1))
+{
+    m_data.types.clear();
+    if (get_emitter_backend() == EmitterBackend::Inja) {
+        // A register template which can't be split renders the whole model, its types are kept until finish()
+        const TemplateLibrary::FileTemplate* register_template = TemplateLibrary::get().get_file_template(get_register_template_path(m_inja_dir));
+        std::optional<SplitRegisterTemplate> split = nullptr != register_template ? split_register_template(*register_template->tmpl) : std::nullopt;
+        if (!split.has_value()) {
+            return;
+        }
+        m_split = std::make_unique<SplitRegisterTemplate>(std::move(split.value()));
+        m_shared_json = make_shared_register_json(m_data);
+    }
+
+    m_loads.resize(m_shards, 0);
+    for (uint32_t shard = 0; shard < m_shards; ++shard) {
+        m_writers.push_back(std::make_unique<StreamingFileWriter>(m_shards > 1 ? get_register_source_shard_path(m_path, shard) : m_path));
+        if (m_split) {
+            TemplateLibrary::get().render_to(m_writers.back()->stream(), m_split->prelude, m_shared_json);
+        } else {
+            TypeRegisterWriter(m_writers.back()->stream(), m_data).write_prelude();
+        }
+    }
+}
+
+zeno::reflect::TypeRegisterStream::~TypeRegisterStream() = default;
+
+void zeno::reflect::TypeRegisterStream::add_type(ReflectedType type)
+{
+    if (m_writers.empty()) {
+        m_data.types.push_back(std::move(type));
+        return;
+    }
+
+    if (m_split) {
+        const size_t shard = assign_register_shard(m_loads, type);
+        m_pending_types.emplace_back(shard, std::move(type));
+        if (m_pending_types.size() >= get_register_render_window()) {
+            render_pending_types();
+        }
+        return;
+    }
+
+    ProfileScope render_scope("render", type.qualified_name);
+    const size_t shard = assign_register_shard(m_loads, type);
+    TypeRegisterWriter(m_writers[shard]->stream(), m_data).write_type(type);
+}
+
+void zeno::reflect::TypeRegisterStream::render_pending_types()
+{
+    if (!m_render_failed && !m_pending_types.empty()) {
+        ProfileScope render_scope("render", m_path);
+        std::vector<const ReflectedType*> types;
+        for (const auto& [shard, type] : m_pending_types) {
+            types.push_back(&type);
+        }
+        std::vector<std::string> sections;
+        if (render_type_sections(*m_split, m_shared_json, types, sections)) {
+            for (size_t i = 0; i < sections.size(); ++i) {
+                m_writers[m_pending_types[i].first]->stream() << sections[i];
+            }
+        } else {
+            m_render_failed = true;
+        }
+    }
+    m_pending_types.clear();
+}
+
+ParserErrorCode zeno::reflect::TypeRegisterStream::finish()
+{
+    if (m_writers.empty()) {
+        return emit_type_register_sources(m_path, m_data, m_inja_dir, m_shards);
+    }
+
+    if (m_split) {
+        render_pending_types();
+        if (m_render_failed) {
+            // Nothing is written, the previous outputs stay in place
+            m_writers.clear();
+            return ParserErrorCode::TUCreationFailure;
+        }
+        for (const std::unique_ptr<StreamingFileWriter>& writer : m_writers) {
+            TemplateLibrary::get().render_to(writer->stream(), m_split->epilogue, m_shared_json);
+        }
+    }
+
+    // Every shard is written, even an empty one, since the build system expects all of them
+    ParserErrorCode result = ParserErrorCode::Success;
+    for (uint32_t shard = 0; shard < m_shards; ++shard) {
+        if (m_writers[shard]->commit() == FileWriteResult::Failed) {
+            std::cerr << std::format("Failed to write {}", m_shards > 1 ? get_register_source_shard_path(m_path, shard) : m_path) << std::endl;
+            result = ParserErrorCode::InternalError;
+        }
+    }
+    m_writers.clear();
+    return result;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "model.hpp"
+#include "native_emitter.hpp"
+#include "parser.hpp"
+
+namespace zeno
+{
+namespace reflect
+{
+    class StreamingFileWriter;
+    struct SplitRegisterTemplate;
+
+    enum class EmitterBackend {
+        /// Render the inja templates, the register template can be replaced through --inja_dir
+        Inja,
+        /// Write the code the built-in templates render, byte for byte, directly from the typed model without building json trees
+        Native,
+    };
+
+    /**
+     * Backend named by --emitter, nullopt for an unknown name.
+    */
+    std::optional<EmitterBackend> parse_emitter_backend(std::string_view name);
+    EmitterBackend get_emitter_backend();
+
+    std::string emit_rtti_block(const RTTIBlockData& data);
+    std::string emit_type_name_block(std::string_view cpp_type, std::string_view disp_name, size_t hash);
+    std::string emit_generated_template_header(std::string_view rtti_block, std::string_view template_include);
+
+    /**
+     * Generate the type register source into `path`.
+     * The inja backend renders `<inja_dir>/reflected_type_register.inja`, the native one writes the equivalent code.
+    */
+    ParserErrorCode emit_type_register_source(const std::string& path, const TypeRegisterData& data, const std::string& inja_dir);
+
+    /**
+     * Path of register source shard `shard`, `<dir>/<stem>.<shard><ext>` for `path` = `<dir>/<stem><ext>`.
+     * Keep in sync with zeno_get_reflection_register_sources in cmake/ReflectionUtils.cmake.
+    */
+    std::string get_register_source_shard_path(const std::string& path, uint32_t shard);
+
+    /**
+     * Split `types` into `shards` lists of indices with similar estimated code size, keeping the input order inside each shard.
+     * Types are assigned in input order, each to the lightest shard so far.
+    */
+    std::vector<std::vector<size_t>> partition_register_types(const std::vector<ReflectedType>& types, uint32_t shards);
+
+    /**
+     * Emit the register source into `path`, or into `shards` files named by get_register_source_shard_path
+     * which can be compiled in parallel.
+    */
+    ParserErrorCode emit_type_register_sources(const std::string& path, const TypeRegisterData& data, const std::string& inja_dir, uint32_t shards);
+
+    /**
+     * Register sources written while types are merged, the output of emit_type_register_sources without holding every type.
+     * The native backend writes each type into its shard right away and drops it. The inja backend renders the sections
+     * of a window of types at once (see split_register_template), only a template which can't be split renders
+     * the whole model and keeps the types until finish().
+    */
+    class TypeRegisterStream {
+    public:
+        /// `data` gives the prefix, headers and template include, its types are ignored
+        TypeRegisterStream(std::string path, TypeRegisterData data, std::string inja_dir, uint32_t shards);
+        ~TypeRegisterStream();
+
+        TypeRegisterStream(const TypeRegisterStream&) = delete;
+        TypeRegisterStream& operator=(const TypeRegisterStream&) = delete;
+
+        void add_type(ReflectedType type);
+
+        /// Replace the outputs whose content changed, nothing is written without it
+        ParserErrorCode finish();
+
+    private:
+        void render_pending_types();
+
+        std::string m_path;
+        TypeRegisterData m_data;
+        std::string m_inja_dir;
+        uint32_t m_shards;
+        std::vector<std::unique_ptr<StreamingFileWriter>> m_writers;
+        std::vector<size_t> m_loads;
+
+        /// Register template the inja backend streams with, null for the native backend
+        std::unique_ptr<SplitRegisterTemplate> m_split;
+        inja::json m_shared_json;
+        /// Types waiting for their sections to be rendered, with their shard
+        std::vector<std::pair<size_t, ReflectedType>> m_pending_types;
+        bool m_render_failed = false;
+    };
+}
+}
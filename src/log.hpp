@@ -6,5 +6,5 @@
 
 #define ZENO_REFLECTION_LOG_DEBUG(...) \
     if (nullptr != GLOBAL_CONTROL_FLAGS && GLOBAL_CONTROL_FLAGS->verbose) {\
-        std::cout << std::format(...) << std::endl;\
+        std::cout << std::format(__VA_ARGS__) << std::endl;\
     }
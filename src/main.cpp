@@ -1,33 +1,29 @@
+#include <string_view>
 #include "args.hpp"
-#include "utils.hpp"
-#include "codegen.hpp"
-#include "parser.hpp"
+#include "log.hpp"
+#include "driver.hpp"
+#include "server.hpp"
+#include "project.hpp"
 
 int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string_view(argv[1]) == "--serve") {
+        ServeFlags serve_flags = argparse::parse<ServeFlags>(argc, argv);
+        return zeno::reflect::run_generator_server(serve_flags);
+    }
+    if (argc > 1 && std::string_view(argv[1]).starts_with("--manifest")) {
+        ManifestFlags manifest_flags = argparse::parse<ManifestFlags>(argc, argv);
+        return zeno::reflect::run_reflection_project(manifest_flags, argv[0]);
+    }
+
     ControlFlags flags = parse_args(argc, argv);
     GLOBAL_CONTROL_FLAGS = &flags;
 
-    ReflectionModel model{};
-    pre_generate_reflection_model();
-
-    int32_t result = 0;
-    zeno::reflect::CodeCompilerState compiler_state {nullptr};
-    for (const std::string& filepath : GLOBAL_CONTROL_FLAGS->input_sources) {
-        std::optional<std::string> source_str = zeno::reflect::read_file(filepath);
-        if (!source_str.has_value()) {
-            std::cerr << std::format("Can't read source file {}", filepath) << std::endl;
-            return 2;
+    if (!GLOBAL_CONTROL_FLAGS->server.empty()) {
+        if (std::optional<int32_t> result = zeno::reflect::run_on_generator_server(GLOBAL_CONTROL_FLAGS->server, argc, argv)) {
+            return result.value();
         }
-        std::string source = source_str.value();
-
-        result += static_cast<int32_t>(generate_reflection_model({
-            .identity_name = filepath,
-            .source = source,
-            .type = TranslationUnitType::Header,
-        }, model, compiler_state));
+        ZENO_REFLECTION_LOG_DEBUG("[debug] No generator is serving {}, running locally", GLOBAL_CONTROL_FLAGS->server);
     }
 
-    post_generate_reflection_model(model, compiler_state);
-
-    return result;
+    return zeno::reflect::run_reflection_generator();
 }
@@ -0,0 +1,119 @@
+#include "model.hpp"
+
+void to_json(inja::json& out, const ReflectedParam& value)
+{
+    out["name"] = value.name;
+    out["type"] = value.type;
+    out["has_default_arg"] = value.has_default_arg;
+    if (value.has_default_arg) {
+        out["default_arg"] = value.default_arg;
+    }
+}
+
+void from_json(const inja::json& in, ReflectedParam& value)
+{
+    value.name = in.at("name").get<std::string>();
+    value.type = in.at("type").get<std::string>();
+    value.has_default_arg = in.value("has_default_arg", false);
+    value.default_arg = in.value("default_arg", "");
+}
+
+void to_json(inja::json& out, const ReflectedConstructor& value)
+{
+    if (value.is_aggregate_initialize) {
+        out["is_aggregate_initialize"] = true;
+    }
+    out["params"] = value.params;
+}
+
+void from_json(const inja::json& in, ReflectedConstructor& value)
+{
+    value.is_aggregate_initialize = in.value("is_aggregate_initialize", false);
+    value.params = in.at("params").get<std::vector<ReflectedParam>>();
+}
+
+void to_json(inja::json& out, const ReflectedFunction& value)
+{
+    out["name"] = value.name;
+    out["ret"] = value.ret;
+    out["params"] = value.params;
+    out["static"] = value.is_static;
+    out["const"] = value.is_const;
+    out["noexcept"] = value.is_noexcept;
+    if (!value.metadata.empty()) {
+        out["metadata"] = value.metadata;
+    }
+}
+
+void from_json(const inja::json& in, ReflectedFunction& value)
+{
+    value.name = in.at("name").get<std::string>();
+    value.ret = in.at("ret").get<std::string>();
+    value.params = in.at("params").get<std::vector<ReflectedParam>>();
+    value.is_static = in.at("static").get<bool>();
+    value.is_const = in.at("const").get<bool>();
+    value.is_noexcept = in.at("noexcept").get<bool>();
+    value.metadata = in.value("metadata", "");
+}
+
+void to_json(inja::json& out, const ReflectedField& value)
+{
+    out["name"] = value.name;
+    out["type"] = value.type;
+    out["normal_type"] = value.normal_type;
+    if (!value.metadata.empty()) {
+        out["metadata"] = value.metadata;
+    }
+}
+
+void from_json(const inja::json& in, ReflectedField& value)
+{
+    value.name = in.at("name").get<std::string>();
+    value.type = in.at("type").get<std::string>();
+    value.normal_type = in.value("normal_type", "");
+    value.metadata = in.value("metadata", "");
+}
+
+void to_json(inja::json& out, const ReflectedBase& value)
+{
+    out["type"] = value.type;
+}
+
+void from_json(const inja::json& in, ReflectedBase& value)
+{
+    value.type = in.at("type").get<std::string>();
+}
+
+void to_json(inja::json& out, const ReflectedType& value)
+{
+    out["normal_name"] = value.normal_name;
+    out["qualified_name"] = value.qualified_name;
+    out["canonical_typename"] = value.canonical_typename;
+    out["canonical_typename_no_prefix"] = value.canonical_typename_no_prefix;
+    out["ctors"] = value.ctors;
+    out["funcs"] = value.funcs;
+    out["fields"] = value.fields;
+    out["base_classes"] = value.base_classes;
+    out["metadata"] = value.metadata;
+}
+
+void from_json(const inja::json& in, ReflectedType& value)
+{
+    value.normal_name = in.at("normal_name").get<std::string>();
+    value.qualified_name = in.at("qualified_name").get<std::string>();
+    value.canonical_typename = in.at("canonical_typename").get<std::string>();
+    value.canonical_typename_no_prefix = in.at("canonical_typename_no_prefix").get<std::string>();
+    value.ctors = in.at("ctors").get<std::vector<ReflectedConstructor>>();
+    value.funcs = in.at("funcs").get<std::vector<ReflectedFunction>>();
+    value.fields = in.at("fields").get<std::vector<ReflectedField>>();
+    value.base_classes = in.at("base_classes").get<std::vector<ReflectedBase>>();
+    value.metadata = in.value("metadata", "");
+}
+
+void to_json(inja::json& out, const TypeRegisterData& value)
+{
+    out["prefix"] = value.prefix;
+    out["headers"] = value.headers;
+    out["template_include"] = value.template_include;
+    out["types"] = value.types;
+}
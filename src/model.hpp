@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "inja/inja.hpp"
+
+/**
+ * Typed form of the data extracted from reflected records.
+ * Emitters read these directly, the inja templates see them through the json conversions below.
+*/
+
+struct ReflectedParam {
+    std::string name;
+    std::string type;
+    bool has_default_arg = false;
+    std::string default_arg;
+};
+
+struct ReflectedConstructor {
+    /// List initialization of an aggregate, params are its fields
+    bool is_aggregate_initialize = false;
+    std::vector<ReflectedParam> params;
+};
+
+struct ReflectedFunction {
+    std::string name;
+    std::string ret;
+    std::vector<ReflectedParam> params;
+    bool is_static = false;
+    bool is_const = false;
+    bool is_noexcept = false;
+    std::string metadata;
+};
+
+struct ReflectedField {
+    std::string name;
+    std::string type;
+    std::string normal_type;
+    std::string metadata;
+};
+
+struct ReflectedBase {
+    std::string type;
+};
+
+struct ReflectedType {
+    std::string normal_name;
+    std::string qualified_name;
+    std::string canonical_typename;
+    std::string canonical_typename_no_prefix;
+    std::vector<ReflectedConstructor> ctors;
+    std::vector<ReflectedFunction> funcs;
+    std::vector<ReflectedField> fields;
+    std::vector<ReflectedBase> base_classes;
+    std::string metadata;
+};
+
+/// Everything the type register source is generated from
+struct TypeRegisterData {
+    std::string prefix;
+    std::vector<std::string> headers;
+    std::string template_include;
+    std::vector<ReflectedType> types;
+};
+
+// Keys match the names used by the inja templates and the reflection cache
+void to_json(inja::json& out, const ReflectedParam& value);
+void from_json(const inja::json& in, ReflectedParam& value);
+void to_json(inja::json& out, const ReflectedConstructor& value);
+void from_json(const inja::json& in, ReflectedConstructor& value);
+void to_json(inja::json& out, const ReflectedFunction& value);
+void from_json(const inja::json& in, ReflectedFunction& value);
+void to_json(inja::json& out, const ReflectedField& value);
+void from_json(const inja::json& in, ReflectedField& value);
+void to_json(inja::json& out, const ReflectedBase& value);
+void from_json(const inja::json& in, ReflectedBase& value);
+void to_json(inja::json& out, const ReflectedType& value);
+void from_json(const inja::json& in, ReflectedType& value);
+void to_json(inja::json& out, const TypeRegisterData& value);
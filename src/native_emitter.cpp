@@ -0,0 +1,335 @@
+#include <format>
+#include "native_emitter.hpp"
+
+namespace
+{
+    template <typename... Args>
+    void append(std::string& out, const Args&... parts)
+    {
+        (out.append(std::string_view(parts)), ...);
+    }
+
+    /// The flags of the `static_cast<size_t>(...)` in RTTI.inja, each followed by a space
+    void append_rtti_flags(std::string& out, const zeno::reflect::RTTIBlockData& data)
+    {
+        if (data.is_pointer) {
+            out += "TF_IsPointer | ";
+        }
+        if (data.is_const) {
+            out += "TF_IsConst | ";
+        }
+        if (data.is_rvalue_ref) {
+            out += "TF_IsRValueRef | ";
+        }
+        if (data.is_lvalue_ref) {
+            out += "TF_IsLValueRef | ";
+        }
+        out += "TF_None ),\n";
+    }
+
+    /// Name of a table, or nullptr for an empty one since C++ has no zero sized arrays
+    std::string table_or_null(size_t size, std::string name)
+    {
+        return size > 0 ? std::move(name) : std::string("nullptr");
+    }
+
+    std::string_view value_or_null(const std::string& value)
+    {
+        return value.empty() ? std::string_view("nullptr") : std::string_view(value);
+    }
+}
+
+std::string zeno::reflect::emit_rtti_block_native(const RTTIBlockData& data)
+{
+    const std::string hash = std::to_string(data.hash);
+    const std::string guard = std::format("_REFLECT_RTTI_GUARD_{}_{}", data.name_normalized, hash);
+    const std::string decayed_type = std::format("typename std::decay<std::remove_pointer<{}>::type>::type", data.cpp_type);
+
+    std::string out;
+    out.reserve(2048 + data.forward_decl.size());
+    append(out, "\n///////////////////////////\n/// Begin RTTI of \"", data.cpp_type, "\"\n");
+    append(out, "#ifndef ", guard, "\n#define ", guard, " 1\n");
+    append(out, data.forward_decl, "\n");
+    append(out, "namespace zeno\n{\nnamespace reflect\n{\n");
+    append(out, "    template <>\n    inline REFLECT_STATIC_CONSTEXPR const RTTITypeInfo& type_info<", data.cpp_type, ">() {\n");
+    append(out, "        if REFLECT_FORCE_CONSTEPXR (std::is_same<", decayed_type, ",", data.cpp_type, ">::value) {\n");
+    append(out, "            static REFLECT_STATIC_CONSTEXPR RTTITypeInfo s = {\n                \"", data.name, "\",\n                ", hash, "ULL,\n");
+    append(out, "                static_cast<size_t>(\n                    ");
+    append_rtti_flags(out, data);
+    append(out, "                0\n            };\n            return s;\n        } else {\n");
+    append(out, "            static REFLECT_STATIC_CONSTEXPR RTTITypeInfo s = {\n                \"", data.name, "\",\n                ", hash, "ULL,\n");
+    append(out, "                static_cast<size_t>(\n                    ");
+    append_rtti_flags(out, data);
+    append(out, "                type_info<", decayed_type, ">().hash_code()\n            };\n            return s;\n        }\n    }\n}\n\n");
+    if (data.disp_name.empty()) {
+        out += "\n\n";
+    } else if (!data.is_pointer && !data.is_const && !data.is_rvalue_ref && !data.is_lvalue_ref) {
+        append(out, "\nnamespace types\n{\n    constexpr size_t gParamType_", data.disp_name, " = ", hash, "ULL;\n}\n");
+    }
+    append(out, "\n\n}\n#endif // ", guard, "\n/// End RTTI of \"", data.cpp_type, "\"\n///////////////////////////\n");
+    return out;
+}
+
+std::string zeno::reflect::emit_type_name_block_native(std::string_view cpp_type, std::string_view disp_name, size_t hash)
+{
+    const std::string hash_text = std::to_string(hash);
+    const std::string guard = std::format("_REFLECT_TYPE_NAME_GUARD_{}_{}", disp_name, hash_text);
+
+    std::string out;
+    append(out, "\n///////////////////////////\n/// Begin name \"", disp_name, "\" of \"", cpp_type, "\"\n");
+    append(out, "#ifndef ", guard, "\n#define ", guard, " 1\n");
+    append(out, "namespace zeno\n{\nnamespace reflect\n{\nnamespace types\n{\n");
+    append(out, "    // Hash of the RTTI libreflect derives for \"", cpp_type, "\", the type has no RTTI block of its own\n");
+    append(out, "    constexpr size_t gParamType_", disp_name, " = ", hash_text, "ULL;\n");
+    append(out, "}\n}\n}\n#endif // ", guard, "\n");
+    append(out, "/// End name \"", disp_name, "\" of \"", cpp_type, "\"\n///////////////////////////\n");
+    return out;
+}
+
+std::string zeno::reflect::emit_generated_template_header_native(std::string_view rtti_block, std::string_view template_include)
+{
+    std::string out;
+    out.reserve(512 + rtti_block.size() + template_include.size());
+    append(out,
+        "\n#pragma once\n\n"
+        "// The generator rebuilds everything below from the sources, it doesn't parse the output of its previous run\n"
+        "#ifndef ZENO_REFLECT_PROCESSING\n\n"
+        "#include \"reflect/type\"\n"
+        "#include \"reflect/polyfill.hpp\"\n"
+        "#include \"reflect/reflection_traits.hpp\"\n"
+        "#include <type_traits>\n\n"
+        "/* include headers from user define */\n");
+    append(out, template_include, "\n\n");
+    append(out, "////////////////////////////////////////////////\n/// Begin generated RTTI for types\n");
+    append(out, rtti_block, "\n");
+    append(out, "/// End generated RTTI for types\n////////////////////////////////////////////////\n\n\n");
+    append(out, "////////////////////////////////////////////////\n/// Begin generated reflected types\n\n");
+    append(out, "/// End generated reflected types\n////////////////////////////////////////////////\n\n");
+    append(out, "#endif // ZENO_REFLECT_PROCESSING\n");
+    return out;
+}
+
+void zeno::reflect::TypeRegisterWriter::write()
+{
+    write_prelude();
+    for (const ReflectedType& type : m_data.types) {
+        write_type(type);
+    }
+}
+
+void zeno::reflect::TypeRegisterWriter::write_prelude()
+{
+    for (const std::string& header : m_data.headers) {
+        m_out << "#include \"" << header << "\"\n";
+    }
+    m_out <<
+        "\n"
+        "#include <string>\n"
+        "#include <vector>\n"
+        "#include <map>\n"
+        "#include <unordered_map>\n"
+        "#include <tuple>\n"
+        "#include <functional>\n"
+        "\n"
+        "#include \"reflect/type\"\n"
+        "#include \"reflect/traits/type_traits\"\n"
+        "#include \"reflect/container/any\"\n"
+        "#include \"reflect/container/unique_ptr\"\n"
+        "#include \"reflect/metadata.hpp\"\n"
+        "#include \"reflect/descriptor.hpp\"\n"
+        "#include \"reflect/reflection_traits.hpp\"\n"
+        "#include \"reflect/reflection.generated.hpp\"\n"
+        "\n"
+        "using namespace zeno::reflect;\n"
+        "\n"
+        "#define _Bool bool\n"
+        "\n";
+}
+
+void zeno::reflect::TypeRegisterWriter::write_type(const ReflectedType& type)
+{
+    m_out << "/// ==== Begin " << type.qualified_name << " Register ====\nnamespace {\n\n";
+
+    m_out << "    /// === Begin Constructor Descriptors ===\n";
+    write_constructors(type);
+    m_out << "    /// === End Constructor Descriptors ===\n\n";
+
+    m_out << "    /// === Begin Member Function Descriptors ===\n";
+    write_functions(type);
+    m_out << "    /// === End Member Function Descriptors ===\n\n";
+
+    m_out << "    /// === Begin Member Field Descriptors ===\n";
+    write_fields(type);
+    m_out << "    /// === End Member Field Descriptors ===\n\n";
+
+    write_type_descriptor(type);
+    write_registrator(type);
+    m_out << "}\n/// ==== End " << type.qualified_name << " Register ====\n";
+}
+
+// Every `{% if %}` of the template keeps the newline after its opening and closing tag,
+// hence the leading and trailing "\n" around the optional parts below
+
+void zeno::reflect::TypeRegisterWriter::write_param_table(const std::vector<ReflectedParam>& params, std::string_view name, bool with_init_value)
+{
+    if (!params.empty()) {
+        m_out << "\n    const ParamDescriptor " << name << "[] = {\n";
+        for (const ReflectedParam& param : params) {
+            m_out << "        { \"" << param.name << "\", &zeno::reflect::type_info<" << param.type << ">, &zeno::reflect::type_info<TTDecay<" << param.type << ">>, ";
+            if (param.has_default_arg) {
+                m_out << "[] () -> Any { return { TInPlaceType<" << param.type << ">{}, " << param.default_arg << " }; }";
+            } else {
+                m_out << "nullptr";
+            }
+            if (with_init_value) {
+                m_out << ", &thunks::init_value<" << param.type << "> },\n";
+            } else {
+                m_out << ", nullptr },\n";
+            }
+        }
+        m_out << "    };\n";
+    }
+    m_out << "\n";
+}
+
+void zeno::reflect::TypeRegisterWriter::write_call_arguments(const std::vector<ReflectedParam>& params)
+{
+    for (size_t i = 0; i < params.size(); ++i) {
+        m_out << "                    any_cast<" << params[i].type << ">(args[" << i << "])";
+        if (i + 1 != params.size()) {
+            m_out << ",";
+        }
+        m_out << "\n";
+    }
+}
+
+void zeno::reflect::TypeRegisterWriter::write_constructors(const ReflectedType& type)
+{
+    for (size_t i = 0; i < type.ctors.size(); ++i) {
+        write_param_table(type.ctors[i].params, std::format("{}_ctor_{}_params", type.normal_name, i), false);
+    }
+    if (!type.ctors.empty()) {
+        m_out << "\n    const ConstructorDescriptor " << type.normal_name << "_ctors[] = {\n";
+        for (size_t i = 0; i < type.ctors.size(); ++i) {
+            const ReflectedConstructor& ctor = type.ctors[i];
+            m_out << "        {\n"
+                  << "            " << table_or_null(ctor.params.size(), std::format("{}_ctor_{}_params", type.normal_name, i)) << ", " << ctor.params.size() << ",\n"
+                  << "            [] (const InvokeArguments& args) -> void* {\n"
+                  << "                return new " << type.canonical_typename_no_prefix << "\n                {\n";
+            write_call_arguments(ctor.params);
+            m_out << "                };\n            },\n"
+                  << "            [] (const InvokeArguments& args) -> Any {\n"
+                  << "                Any val{};\n"
+                  << "                val.emplace<" << type.canonical_typename_no_prefix << ">\n                (\n";
+            if (ctor.is_aggregate_initialize) {
+                m_out << "\n                    " << type.qualified_name << " {\n";
+            }
+            m_out << "\n";
+            write_call_arguments(ctor.params);
+            if (ctor.is_aggregate_initialize) {
+                m_out << "\n                    }\n";
+            }
+            m_out << "\n                );\n                return val;\n            },\n        },\n";
+        }
+        m_out << "    };\n";
+    }
+    m_out << "\n";
+}
+
+void zeno::reflect::TypeRegisterWriter::write_functions(const ReflectedType& type)
+{
+    for (size_t i = 0; i < type.funcs.size(); ++i) {
+        write_param_table(type.funcs[i].params, std::format("{}_func_{}_params", type.normal_name, i), true);
+    }
+    if (!type.funcs.empty()) {
+        m_out << "\n    const FunctionDescriptor " << type.normal_name << "_funcs[] = {\n";
+        for (size_t i = 0; i < type.funcs.size(); ++i) {
+            const ReflectedFunction& func = type.funcs[i];
+            m_out << "        {\n"
+                  << "            \"" << func.name << "\", " << table_or_null(func.params.size(), std::format("{}_func_{}_params", type.normal_name, i)) << ", " << func.params.size() << ",\n"
+                  << "            &get_type<" << func.ret << ">, &zeno::reflect::type_info<" << func.ret << ">,\n"
+                  << "            " << (func.is_static ? "true" : "false") << ", " << (func.is_const ? "true" : "false") << ", " << (func.is_noexcept ? "true" : "false") << ",\n"
+                  << "            [] (void* object, const InvokeArguments& args) -> Any {\n"
+                  << "                ";
+            if (func.ret != "void") {
+                m_out << "return ";
+            }
+            if (func.is_static) {
+                m_out << type.qualified_name << "::";
+            } else {
+                m_out << "static_cast<" << type.qualified_name << "*>(object)->";
+            }
+            // `{{- func.name -}}` in the template strips the line break before the parenthesis
+            m_out << func.name << "(\n";
+            write_call_arguments(func.params);
+            m_out << "                );\n";
+            if (func.ret == "void") {
+                m_out << "\n                return Any::make_null();\n";
+            }
+            m_out << "\n"
+                  << "            },\n"
+                  << "            " << value_or_null(func.metadata) << ",\n"
+                  << "        },\n";
+        }
+        m_out << "    };\n";
+    }
+    m_out << "\n";
+}
+
+void zeno::reflect::TypeRegisterWriter::write_fields(const ReflectedType& type)
+{
+    if (!type.fields.empty()) {
+        m_out << "\n    const FieldDescriptor " << type.normal_name << "_fields[] = {\n";
+        for (const ReflectedField& field : type.fields) {
+            const std::string member = std::format("&{}::{}", type.qualified_name, field.name);
+            m_out << "        {\n"
+                  << "            \"" << field.name << "\", &get_type<" << field.type << ">,\n"
+                  << "            &thunks::field_ptr<" << member << ">,\n"
+                  << "            &thunks::get_field_value<" << member << ">,\n"
+                  << "            &thunks::set_field_value<" << member << ">,\n"
+                  << "            " << value_or_null(field.metadata) << ",\n"
+                  << "        },\n";
+        }
+        m_out << "    };\n";
+    }
+    m_out << "\n";
+}
+
+void zeno::reflect::TypeRegisterWriter::write_type_descriptor(const ReflectedType& type)
+{
+    m_out << "    /// === Begin Record Type Descriptor ===\n";
+    if (!type.base_classes.empty()) {
+        m_out << "\n    const TypeHandleGetter " << type.normal_name << "_bases[] = {\n";
+        for (const ReflectedBase& base : type.base_classes) {
+            m_out << "        &get_type<" << base.type << ">,\n";
+        }
+        m_out << "    };\n";
+    }
+    m_out << "\n"
+          << "    const TypeDescriptor " << type.normal_name << "_descriptor {\n"
+          << "        &zeno::reflect::type_info<" << type.canonical_typename << ">,\n"
+          << "        &thunks::object_ptr<" << type.qualified_name << ">,\n"
+          << "        " << table_or_null(type.ctors.size(), type.normal_name + "_ctors") << ", " << type.ctors.size() << ",\n"
+          << "        " << table_or_null(type.funcs.size(), type.normal_name + "_funcs") << ", " << type.funcs.size() << ",\n"
+          << "        " << table_or_null(type.fields.size(), type.normal_name + "_fields") << ", " << type.fields.size() << ",\n"
+          << "        " << table_or_null(type.base_classes.size(), type.normal_name + "_bases") << ", " << type.base_classes.size() << ",\n"
+          << "        " << value_or_null(type.metadata) << ",\n"
+          << "    };\n"
+          << "    /// === End Record Type Descriptor ===\n\n";
+}
+
+void zeno::reflect::TypeRegisterWriter::write_registrator(const ReflectedType& type)
+{
+    const std::string registrator = std::format("S{}Registrator", type.normal_name);
+    m_out << "    /// === Begin Static Registor ===\n"
+          << "    struct " << registrator << " {\n"
+          << "        " << registrator << "() {\n"
+          << "            ReflectedTypeInfo info {};\n"
+          << "            info.prefix = \"" << m_data.prefix << "\";\n"
+          << "            info.qualified_name = \"" << type.qualified_name << "\";\n"
+          << "            info.canonical_typename = \"" << type.canonical_typename << "\";\n\n"
+          << "            (ReflectionRegistry::get())->add(new TableType(info, " << type.normal_name << "_descriptor));\n"
+          << "        }\n    };\n"
+          << "    static " << registrator << " global_" << registrator << "{};\n"
+          << "    /// === End Static Registor ===\n";
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "model.hpp"
+
+namespace zeno
+{
+namespace reflect
+{
+    /// Data of a single RTTI specialization, see template/RTTI.inja
+    struct RTTIBlockData {
+        std::string forward_decl;
+        std::string cpp_type;
+        std::string name_normalized;
+        std::string name;
+        std::string disp_name;
+        size_t hash = 0;
+        bool is_pointer = false;
+        bool is_const = false;
+        bool is_rvalue_ref = false;
+        bool is_lvalue_ref = false;
+    };
+
+    /**
+     * The RTTI block of `data`, byte for byte what template/RTTI.inja renders.
+    */
+    std::string emit_rtti_block_native(const RTTIBlockData& data);
+
+    /**
+     * The display name constant of a type without an RTTI block, byte for byte what template/type_name.inja renders.
+    */
+    std::string emit_type_name_block_native(std::string_view cpp_type, std::string_view disp_name, size_t hash);
+
+    /**
+     * The generated template header, byte for byte what template/generated_template_header.inja renders.
+    */
+    std::string emit_generated_template_header_native(std::string_view rtti_block, std::string_view template_include);
+
+    /**
+     * Writes the type register source byte for byte as template/reflected_type_register.inja renders it,
+     * blank lines left by its control statements included.
+    */
+    class TypeRegisterWriter {
+    public:
+        TypeRegisterWriter(std::ostream& out, const TypeRegisterData& data) : m_out(out), m_data(data) {}
+
+        void write();
+
+        /// Includes and declarations preceding the types
+        void write_prelude();
+
+        void write_type(const ReflectedType& type);
+
+    private:
+        /// `const ParamDescriptor <name>[]`, `with_init_value` adds the value initialized argument factories
+        void write_param_table(const std::vector<ReflectedParam>& params, std::string_view name, bool with_init_value);
+        void write_call_arguments(const std::vector<ReflectedParam>& params);
+        void write_constructors(const ReflectedType& type);
+        void write_functions(const ReflectedType& type);
+        void write_fields(const ReflectedType& type);
+        void write_type_descriptor(const ReflectedType& type);
+        void write_registrator(const ReflectedType& type);
+
+        std::ostream& m_out;
+        const TypeRegisterData& m_data;
+    };
+}
+}
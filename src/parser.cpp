@@ -1,13 +1,25 @@
 #include <clang/AST/DeclCXX.h>
 #include <fstream>
+#include <cassert>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
 #include "args.hpp"
 #include "log.hpp"
 #include "utils.hpp"
 #include "parser.hpp"
 #include "serialize.hpp"
 #include "codegen.hpp"
+#include "preamble.hpp"
+#include "template_library.hpp"
+#include "emitter.hpp"
+#include "profiler.hpp"
 #include "template/template_literal"
 #include "clang/Sema/Sema.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/AST/RecursiveASTVisitor.h"
 
 using namespace llvm;
 using namespace clang;
@@ -16,97 +28,586 @@ using namespace clang::ast_matchers;
 
 template <class T>
 inline void add_type_to_generator(T* context, clang::QualType type, const std::string& dispName = "") {
-    auto& gen = context->template_header_generator;
-    auto& scoped_ctx = context->scoped_context;
+    // Qualified variants of the type are derived by libreflect
+    context->template_header_generator->add_rtti_type(type, dispName);
+}
 
-    auto add_rtti_type = [&](clang::QualType qt, const std::string& dispName = "", bool hasConstMark = false) { 
-        gen->add_rtti_type(qt, dispName, hasConstMark);
-    };
+class IncludeGraphCollector : public PPCallbacks {
+public:
+    IncludeGraphCollector(const SourceManager& source_manager, std::shared_ptr<IncludeGraph> graph) : m_source_manager(source_manager), m_graph(std::move(graph)) {}
 
-    add_rtti_type(type, dispName);
+    void FileChanged(SourceLocation loc, FileChangeReason reason, SrcMgr::CharacteristicKind file_type, FileID prev_fid) override {
+        if (reason != EnterFile) {
+            return;
+        }
+        const FileID file_id = m_source_manager.getFileID(m_source_manager.getExpansionLoc(loc));
+        if (file_id == m_source_manager.getMainFileID()) {
+            return;
+        }
+        if (std::optional<std::string> file = get_file_name(file_id)) {
+            add_edge(m_source_manager.getIncludeLoc(file_id), std::move(file.value()));
+        }
+    }
 
-    auto non_ref_type = type.getNonReferenceType();
-    non_ref_type.removeLocalConst();
-    auto canonical_type = non_ref_type->getCanonicalTypeUnqualified();
+    void FileSkipped(const FileEntryRef& skipped_file, const Token& filename_tok, SrcMgr::CharacteristicKind file_type) override {
+        // Skipped by include guards, but the includer still depends on it
+        add_edge(filename_tok.getLocation(), zeno::reflect::normalize_path(skipped_file.getName()));
+    }
+
+private:
+    void add_edge(SourceLocation include_loc, std::string file) {
+        std::optional<std::string> includer;
+        if (include_loc.isValid()) {
+            includer = get_file_name(m_source_manager.getFileID(m_source_manager.getExpansionLoc(include_loc)));
+        }
+        if (includer.has_value()) {
+            m_graph->edges[includer.value()].insert(std::move(file));
+        } else {
+            m_graph->roots.insert(std::move(file));
+        }
+    }
 
-    add_rtti_type(scoped_ctx->getConstType(canonical_type), dispName);
-    add_rtti_type(scoped_ctx->getLValueReferenceType(canonical_type), dispName);
-    add_rtti_type(scoped_ctx->getRValueReferenceType(canonical_type), dispName);
-    add_rtti_type(scoped_ctx->getLValueReferenceType(scoped_ctx->getConstType(canonical_type)), dispName, true);
-    add_rtti_type(scoped_ctx->getPointerType(scoped_ctx->getConstType(canonical_type)), dispName);
-    add_rtti_type(scoped_ctx->getPointerType(canonical_type), dispName);
+    std::optional<std::string> get_file_name(FileID file_id) const {
+        if (auto entry = m_source_manager.getFileEntryRefForID(file_id)) {
+            return zeno::reflect::normalize_path(entry->getName());
+        }
+        return std::nullopt;
+    }
+
+    const SourceManager& m_source_manager;
+    std::shared_ptr<IncludeGraph> m_graph;
+};
+
+std::unique_ptr<PPCallbacks> create_include_graph_collector(const SourceManager& source_manager, std::shared_ptr<IncludeGraph> graph)
+{
+    return std::make_unique<IncludeGraphCollector>(source_manager, std::move(graph));
+}
+
+std::vector<std::string> IncludeGraph::collect_dependencies(const std::string &file) const
+{
+    std::set<std::string> visited;
+    std::vector<std::string> pending { file };
+    pending.insert(pending.end(), roots.begin(), roots.end());
+    while (!pending.empty()) {
+        std::string current = std::move(pending.back());
+        pending.pop_back();
+        if (!visited.insert(current).second) {
+            continue;
+        }
+        if (auto it = edges.find(current); it != edges.end()) {
+            pending.insert(pending.end(), it->second.begin(), it->second.end());
+        }
+    }
+    return { visited.begin(), visited.end() };
 }
 
 class ReflectionGeneratorAction : public ASTFrontendAction {
 public:
-    ReflectionGeneratorAction(zeno::reflect::CodeCompilerState& compielr_state, std::string header_path): m_compiler_state(compielr_state), m_header_path(std::move(header_path)) {}
+    ReflectionGeneratorAction(zeno::reflect::CodeCompilerState& compielr_state, std::span<HeaderReflectionResult> results): m_compiler_state(compielr_state), m_results(results) {}
 
     std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &compiler, StringRef code) override {
-        return std::make_unique<ReflectionASTConsumer>(m_compiler_state, m_header_path, compiler);
+        auto consumer = std::make_unique<ReflectionASTConsumer>(m_compiler_state, m_results, compiler);
+        compiler.getPreprocessor().addPPCallbacks(create_include_graph_collector(compiler.getSourceManager(), consumer->include_graph));
+        return consumer;
+    }
+
+protected:
+    /**
+     * Only declarations are reflected, so the parse is trimmed to what produces them.
+     * Language options are left alone, they have to match the precompiled preamble.
+    */
+    bool BeginInvocation(CompilerInstance &compiler) override {
+        if (!GLOBAL_CONTROL_FLAGS->parse_function_bodies) {
+            // Bodies of constexpr functions and of functions with a deduced return type are still parsed, clang needs them for the declaration
+            compiler.getFrontendOpts().SkipFunctionBodies = true;
+        }
+        // The compiler building the target reports warnings, here they would only be printed twice
+        compiler.getDiagnostics().setIgnoreAllWarnings(true);
+        return ASTFrontendAction::BeginInvocation(compiler);
     }
 
 private:
     zeno::reflect::CodeCompilerState& m_compiler_state;
-    std::string m_header_path;
+    std::span<HeaderReflectionResult> m_results;
+};
+
+/// Set by pre_generate_reflection_model when a precompiled preamble replaces the pre-include headers
+static std::optional<zeno::reflect::PrecompiledPreamble> precompiled_preamble;
+
+/// One per worker, kept across the requests of a resident generator while still current
+static std::vector<std::unique_ptr<ParseSession>> parse_sessions;
+
+static std::filesystem::file_time_type get_file_stamp(const std::string& path) {
+    std::error_code err;
+    const auto write_time = std::filesystem::last_write_time(path, err);
+    // Files which don't exist yet are tracked too, creating one may change how includes resolve
+    return err ? std::filesystem::file_time_type::min() : write_time;
+}
+
+static std::string get_working_dir() {
+    std::error_code err;
+    return std::filesystem::current_path(err).string();
+}
+
+/**
+ * Real file system keeping every status and file content it was asked for.
+ * The FileManager only caches lookups, each parse would open and read its includes again otherwise.
+*/
+class CachingFileSystem : public llvm::vfs::ProxyFileSystem {
+public:
+    CachingFileSystem() : ProxyFileSystem(llvm::vfs::getRealFileSystem()) {}
+
+    llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine &path) override {
+        const std::string key = path.str();
+        if (auto it = m_statuses.find(key); it != m_statuses.end()) {
+            return it->second;
+        }
+        return m_statuses.emplace(key, ProxyFileSystem::status(path)).first->second;
+    }
+
+    llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> openFileForRead(const llvm::Twine &path) override {
+        const std::string key = path.str();
+        auto it = m_files.find(key);
+        if (it == m_files.end()) {
+            llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> file = ProxyFileSystem::openFileForRead(path);
+            if (!file) {
+                return file.getError();
+            }
+            llvm::ErrorOr<llvm::vfs::Status> file_status = (*file)->status();
+            llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer = (*file)->getBuffer(key);
+            if (!file_status || !buffer) {
+                return file_status ? buffer.getError() : file_status.getError();
+            }
+            it = m_files.emplace(key, CachedFileData{ file_status.get(), std::shared_ptr<llvm::MemoryBuffer>(std::move(buffer.get())) }).first;
+        }
+        return std::unique_ptr<llvm::vfs::File>(std::make_unique<CachedFile>(it->second));
+    }
+
+private:
+    struct CachedFileData {
+        llvm::vfs::Status status;
+        std::shared_ptr<llvm::MemoryBuffer> buffer;
+    };
+
+    class CachedFile : public llvm::vfs::File {
+    public:
+        explicit CachedFile(CachedFileData data) : m_data(std::move(data)) {}
+
+        llvm::ErrorOr<llvm::vfs::Status> status() override {
+            return m_data.status;
+        }
+
+        llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> getBuffer(const llvm::Twine &name, int64_t file_size, bool requires_null_terminator, bool is_volatile) override {
+            // Buffers read from disk are null terminated
+            return llvm::MemoryBuffer::getMemBuffer(m_data.buffer->getMemBufferRef(), requires_null_terminator);
+        }
+
+        std::error_code close() override {
+            return {};
+        }
+
+    private:
+        CachedFileData m_data;
+    };
+
+    std::unordered_map<std::string, llvm::ErrorOr<llvm::vfs::Status>> m_statuses;
+    std::unordered_map<std::string, CachedFileData> m_files;
 };
 
-ParserErrorCode generate_reflection_model(const TranslationUnit &unit, ReflectionModel &out_model, zeno::reflect::CodeCompilerState& root_state) {
-    out_model.debug_name = unit.identity_name;
-    std::vector<std::string> args = zeno::reflect::get_parser_command_args(GLOBAL_CONTROL_FLAGS->cpp_version, GLOBAL_CONTROL_FLAGS->include_dirs, GLOBAL_CONTROL_FLAGS->pre_include_headers, GLOBAL_CONTROL_FLAGS->verbose);
+ParseSession::ParseSession() {
+    reset();
+}
+
+void ParseSession::reset() {
+    llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> overlay_files(new llvm::vfs::OverlayFileSystem(new CachingFileSystem()));
+    m_memory_files = new llvm::vfs::InMemoryFileSystem();
+    overlay_files->pushOverlay(m_memory_files);
+    m_files = new clang::FileManager(clang::FileSystemOptions(), overlay_files);
+    m_working_dir = get_working_dir();
+    m_stamps.clear();
+}
+
+bool ParseSession::run(std::unique_ptr<clang::FrontendAction> action, const std::string& code, const std::vector<std::string>& args, const std::string& file_name) {
+    // The overlay can't replace a file, another content under the same name needs fresh caches
+    if (!m_memory_files->addFile(file_name, 0, llvm::MemoryBuffer::getMemBufferCopy(code, file_name))) {
+        ZENO_REFLECTION_LOG_DEBUG("[debug] {} changed within a parse session, dropping its cached files", file_name);
+        reset();
+        m_memory_files->addFile(file_name, 0, llvm::MemoryBuffer::getMemBufferCopy(code, file_name));
+    }
+
+    std::vector<std::string> command_line { "clang-tool", "-fsyntax-only" };
+    command_line.insert(command_line.end(), args.begin(), args.end());
+    command_line.push_back(file_name);
+    clang::tooling::ToolInvocation invocation(std::move(command_line), std::move(action), m_files.get());
+    return invocation.run();
+}
 
+void ParseSession::track_files(const std::vector<std::string>& files) {
+    for (const std::string& file : files) {
+        if (!m_stamps.contains(file)) {
+            m_stamps.emplace(file, get_file_stamp(file));
+        }
+        // Adding or removing a file changes its directory, which covers includes that didn't resolve there before
+        const std::string directory = std::filesystem::path(file).parent_path().string();
+        if (!directory.empty() && !m_stamps.contains(directory)) {
+            m_stamps.emplace(directory, get_file_stamp(directory));
+        }
+    }
+}
+
+bool ParseSession::is_current() const {
+    if (m_working_dir != get_working_dir()) {
+        return false;
+    }
+    for (const auto& [path, stamp] : m_stamps) {
+        if (get_file_stamp(path) != stamp) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ParseSession& get_parse_session(uint32_t worker_id) {
+    assert(worker_id < parse_sessions.size());
+    return *parse_sessions[worker_id];
+}
+
+std::vector<std::string> get_generator_command_args() {
+    if (precompiled_preamble.has_value()) {
+        std::vector<std::string> no_pre_include_headers;
+        std::vector<std::string> args = zeno::reflect::get_parser_command_args(GLOBAL_CONTROL_FLAGS->cpp_version, GLOBAL_CONTROL_FLAGS->include_dirs, no_pre_include_headers, GLOBAL_CONTROL_FLAGS->verbose);
+        args.push_back("-include-pch");
+        args.push_back(precompiled_preamble->pch_path);
+        return args;
+    }
+    return zeno::reflect::get_parser_command_args(GLOBAL_CONTROL_FLAGS->cpp_version, GLOBAL_CONTROL_FLAGS->include_dirs, GLOBAL_CONTROL_FLAGS->pre_include_headers, GLOBAL_CONTROL_FLAGS->verbose);
+}
+
+/**
+ * Header holding the RTTI specializations of every reflected header of the target.
+*/
+static std::string get_target_rtti_header_path() {
+    return zeno::reflect::get_file_path_in_header_output(std::format("reflect/{0}/{0}.rtti.generated.hpp", GLOBAL_CONTROL_FLAGS->target_name));
+}
+
+/**
+ * Umbrella header of a target, including its RTTI header and the umbrella headers of the generated targets it links.
+*/
+static std::string get_target_umbrella_header_path(std::string_view target_name) {
+    return zeno::reflect::get_file_path_in_header_output(std::format("reflect/{}.generated.hpp", target_name));
+}
+
+/**
+ * Include root added in front of the include dirs of a target, "reflect/reflection.generated.hpp" resolves to its umbrella header there.
+*/
+static std::string get_target_include_root(std::string_view target_name) {
+    return zeno::reflect::get_file_path_in_header_output(std::format("reflect/{}/include", target_name));
+}
+
+/**
+ * Files the generator wrote for a target into the header output, relative to it and one per line.
+*/
+static std::string get_target_outputs_manifest_path(std::string_view target_name) {
+    return zeno::reflect::get_file_path_in_header_output(std::format("reflect/{0}/{0}.outputs", target_name));
+}
+
+static void prepare_reflection_result(const TranslationUnit &unit, HeaderReflectionResult &out_result) {
     const std::string template_header_dir = zeno::reflect::get_file_path_in_header_output(std::format("reflect/{}", GLOBAL_CONTROL_FLAGS->target_name));
     const std::string gen_template_header_path = std::format("{}/{}.generated.hpp", template_header_dir, zeno::reflect::normalize_filename(unit.identity_name));
     zeno::reflect::mkdirs(template_header_dir);
-    zeno::reflect::truncate_file(gen_template_header_path);
-    out_model.generated_headers.insert(gen_template_header_path);
+    out_result.identity_name = unit.identity_name;
+    out_result.generated_header_path = gen_template_header_path;
+}
 
-    if (!clang::tooling::runToolOnCodeWithArgs(
-        std::make_unique<ReflectionGeneratorAction>(root_state, gen_template_header_path),
-        unit.source.c_str(),
+void prepare_skipped_reflection_result(const TranslationUnit &unit, const std::set<std::string>& scanned_files, HeaderReflectionResult &out_result) {
+    prepare_reflection_result(unit, out_result);
+    out_result.dependencies.assign(scanned_files.begin(), scanned_files.end());
+}
+
+ParserErrorCode generate_reflection_model(const TranslationUnit &unit, HeaderReflectionResult &out_result, zeno::reflect::CodeCompilerState& worker_state, ParseSession& session) {
+    zeno::reflect::ProfileScope header_scope("header", unit.identity_name);
+    std::vector<std::string> args;
+    {
+        zeno::reflect::ProfileScope setup_scope("setup", unit.identity_name);
+        args = get_generator_command_args();
+        prepare_reflection_result(unit, out_result);
+    }
+
+    if (!session.run(
+        std::make_unique<ReflectionGeneratorAction>(worker_state, std::span<HeaderReflectionResult>(&out_result, 1)),
+        unit.source,
         args,
-        unit.identity_name.c_str()
+        unit.identity_name
     )) {
         return ParserErrorCode::InternalError;
     }
+    session.track_files(out_result.dependencies);
 
     return ParserErrorCode::Success;
 }
 
-ParserErrorCode post_generate_reflection_model(const ReflectionModel &model, const zeno::reflect::CodeCompilerState& state)
+ParserErrorCode generate_reflection_model_batched(std::span<const TranslationUnit> units, std::span<HeaderReflectionResult> out_results, zeno::reflect::CodeCompilerState &worker_state, ParseSession& session)
 {
-    const std::string generated_header_dir = zeno::reflect::get_file_path_in_header_output("reflect");
-    const std::string generated_header_path = zeno::reflect::get_file_path_in_header_output("reflect/reflection.generated.hpp");
+    assert(units.size() == out_results.size());
+    if (units.empty()) {
+        return ParserErrorCode::Success;
+    }
 
-    std::ofstream ghp_stream(generated_header_path, std::ios::out | std::ios::trunc);
-    ghp_stream << "#pragma once\r\n";
+    const std::string batch_name = zeno::reflect::get_file_path_in_header_output(std::format("reflect/{}/{}.batch.cpp", GLOBAL_CONTROL_FLAGS->target_name, zeno::reflect::normalize_filename(units.front().identity_name)));
+    zeno::reflect::ProfileScope header_scope("header", batch_name);
+
+    std::vector<std::string> args;
+    // ReflectionASTConsumer hands each unit the declarations of the files its header includes
+    std::string batch_source;
+    {
+        zeno::reflect::ProfileScope setup_scope("setup", batch_name);
+        args = get_generator_command_args();
+        for (size_t i = 0; i < units.size(); ++i) {
+            prepare_reflection_result(units[i], out_results[i]);
+            batch_source += std::format("#include \"{}\"\n", units[i].identity_name);
+        }
+    }
 
-    for (const std::string& s : zeno::reflect::find_files_with_extension(generated_header_dir, ".hpp")) {
-        const auto relative_path = zeno::reflect::relative_path_to_header_output(s);
-        if (zeno::reflect::relative_path_to_header_output(generated_header_path) != relative_path) {
-            ghp_stream << std::format("#include \"{}\"", relative_path) << "\r\n";
+    if (!session.run(
+        std::make_unique<ReflectionGeneratorAction>(worker_state, out_results),
+        batch_source,
+        args,
+        batch_name
+    )) {
+        return ParserErrorCode::InternalError;
+    }
+    for (const HeaderReflectionResult& result : out_results) {
+        session.track_files(result.dependencies);
+    }
+
+    return ParserErrorCode::Success;
+}
+
+ParserErrorCode merge_reflection_result(HeaderReflectionResult &result, ReflectionModel &out_model, zeno::reflect::CodeCompilerState &root_state, zeno::reflect::TypeRegisterStream& register_stream)
+{
+    zeno::reflect::ProfileScope merge_scope("merge", result.identity_name);
+    out_model.debug_name = result.identity_name;
+    out_model.generated_headers.insert(result.generated_header_path);
+    out_model.dependencies.insert(zeno::reflect::normalize_path(result.identity_name));
+    out_model.dependencies.insert(result.dependencies.begin(), result.dependencies.end());
+
+    // Blocks first merged from this header are defined in its generated header, the others come from the header defining them.
+    // Results must be merged in input order, so the RTTI header lists types in the same order as a serial run.
+    const std::string generated_header_include = zeno::reflect::relative_path_to_header_output(result.generated_header_path);
+    std::set<std::string> rtti_includes;
+    std::string rtti_block;
+    for (GeneratedRTTIBlock& block : result.rtti_blocks) {
+        if (block.hash != 0) {
+            auto it = root_state.rtti_block_headers.find(block.hash);
+            if (it == root_state.rtti_block_headers.end() && !block.code.empty()) {
+                root_state.rtti_block_headers.emplace(block.hash, generated_header_include);
+            } else {
+                if (it != root_state.rtti_block_headers.end() && it->second != generated_header_include) {
+                    rtti_includes.insert(it->second);
+                }
+                continue;
+            }
         }
+        rtti_block += block.code;
     }
+    result.rtti_blocks.clear();
 
-    const std::string generated_target_source = GLOBAL_CONTROL_FLAGS->target_type_register_source_path;
-    std::ofstream gts_stream(generated_target_source, std::ios::out | std::ios::trunc);
-    std::string injaPath = state.inja_dir + "/" + "reflected_type_register.inja";
+    for (ReflectedType& type_data : result.types) {
+        if (root_state.registered_type_names.insert(type_data.normal_name).second) {
+            register_stream.add_type(std::move(type_data));
+        }
+    }
+    result.types.clear();
 
-    std::ifstream file;
-    file.open(injaPath);
-    if (!file.fail()) {
-        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-        gts_stream << inja::render(text, state.types_register_data);
-        return ParserErrorCode::Success;
+    // Code including the generated header of a single reflected header only pays for the types that header uses
+    std::string rtti_include_block;
+    for (const std::string& include : rtti_includes) {
+        rtti_include_block += std::format("#include \"{}\"\n", include);
     }
-    else {
-        return ParserErrorCode::TUCreationFailure;
+    const std::string generated_header = zeno::reflect::emit_generated_template_header(rtti_include_block + rtti_block, root_state.type_register_data.template_include);
+    if (zeno::reflect::write_file_if_changed(result.generated_header_path, generated_header) == zeno::reflect::FileWriteResult::Failed) {
+        std::cerr << std::format("Failed to write {}", result.generated_header_path) << std::endl;
+        return ParserErrorCode::InternalError;
     }
+    root_state.rtti_headers.push_back(generated_header_include);
+
+    return ParserErrorCode::Success;
 }
 
-ParserErrorCode pre_generate_reflection_model()
+/**
+ * Escape a path for a Makefile style depfile, as understood by make and ninja.
+*/
+static std::string escape_depfile_path(std::string_view path)
+{
+    std::string escaped;
+    escaped.reserve(path.size());
+    for (char c : path) {
+        if (c == ' ' || c == '#') {
+            escaped.push_back('\\');
+        } else if (c == '$') {
+            escaped.push_back('$');
+        }
+        escaped.push_back(c);
+    }
+    return escaped;
+}
+
+bool write_depfile(const std::string& depfile_path, const std::string& target, const std::set<std::string>& dependencies)
+{
+    std::string content = escape_depfile_path(zeno::reflect::normalize_path(target)) + ":";
+    for (const std::string& dependency : dependencies) {
+        content += " \\\n  " + escape_depfile_path(dependency);
+    }
+    content += "\n";
+    return zeno::reflect::write_file_if_changed(depfile_path, content) != zeno::reflect::FileWriteResult::Failed;
+}
+
+ParserErrorCode post_generate_reflection_model(const ReflectionModel &model, const zeno::reflect::CodeCompilerState& state, zeno::reflect::TypeRegisterStream& register_stream)
 {
+    if (!GLOBAL_CONTROL_FLAGS->depfile.empty()) {
+        const std::string& depfile_target = GLOBAL_CONTROL_FLAGS->depfile_target.empty() ? GLOBAL_CONTROL_FLAGS->target_type_register_source_path : GLOBAL_CONTROL_FLAGS->depfile_target;
+        if (!write_depfile(GLOBAL_CONTROL_FLAGS->depfile, depfile_target, model.dependencies)) {
+            std::cerr << std::format("Failed to write depfile {}", GLOBAL_CONTROL_FLAGS->depfile) << std::endl;
+        }
+    }
+
+    const std::string rtti_header_path = get_target_rtti_header_path();
+    std::string rtti_header;
+    {
+        zeno::reflect::ProfileScope render_scope("render", rtti_header_path);
+        std::string rtti_block;
+        for (const std::string& header : state.rtti_headers) {
+            rtti_block += std::format("#include \"{}\"\n", header);
+        }
+        rtti_header = zeno::reflect::emit_generated_template_header(rtti_block, state.type_register_data.template_include);
+    }
+    zeno::reflect::mkdirs(std::filesystem::path(rtti_header_path).parent_path().string());
+    if (zeno::reflect::write_file_if_changed(rtti_header_path, rtti_header) == zeno::reflect::FileWriteResult::Failed) {
+        std::cerr << std::format("Failed to write {}", rtti_header_path) << std::endl;
+        return ParserErrorCode::InternalError;
+    }
+
+    // Linked libraries which aren't plain target names, like aliases and linker flags, can't have an umbrella header
+    const std::string& target_name = GLOBAL_CONTROL_FLAGS->target_name;
+    auto is_plain_target_name = [&target_name](std::string_view name) {
+        return !name.empty() && name != target_name && name.front() != '-' && std::all_of(name.begin(), name.end(), [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-' || c == '.' || c == '+';
+        });
+    };
+    const std::string umbrella_header_path = get_target_umbrella_header_path(target_name);
+    std::string umbrella_header = "#pragma once\r\n#ifndef ZENO_REFLECT_PROCESSING\r\n";
+    umbrella_header += std::format("#include \"{}\"\r\n", zeno::reflect::relative_path_to_header_output(rtti_header_path));
+    for (const std::string& link_target : GLOBAL_CONTROL_FLAGS->link_targets) {
+        if (is_plain_target_name(link_target)) {
+            umbrella_header += std::format("#if __has_include(\"reflect/{0}.generated.hpp\")\r\n#include \"reflect/{0}.generated.hpp\"\r\n#endif\r\n", link_target);
+        }
+    }
+    umbrella_header += "#endif\r\n";
+
+    const std::string include_root_header_path = (std::filesystem::path(get_target_include_root(target_name)) / "reflect" / "reflection.generated.hpp").string();
+    const std::string include_root_header = std::format(
+        "#pragma once\r\n#ifndef ZENO_REFLECT_PROCESSING\r\n#include \"{}\"\r\n#endif\r\n",
+        zeno::reflect::relative_path_to_header_output(umbrella_header_path)
+    );
+    zeno::reflect::mkdirs(std::filesystem::path(include_root_header_path).parent_path().string());
+    if (zeno::reflect::write_file_if_changed(umbrella_header_path, umbrella_header) == zeno::reflect::FileWriteResult::Failed) {
+        std::cerr << std::format("Failed to write {}", umbrella_header_path) << std::endl;
+        return ParserErrorCode::InternalError;
+    }
+    if (zeno::reflect::write_file_if_changed(include_root_header_path, include_root_header) == zeno::reflect::FileWriteResult::Failed) {
+        std::cerr << std::format("Failed to write {}", include_root_header_path) << std::endl;
+        return ParserErrorCode::InternalError;
+    }
+
+    std::set<std::string> outputs {
+        zeno::reflect::relative_path_to_header_output(rtti_header_path),
+        zeno::reflect::relative_path_to_header_output(umbrella_header_path),
+        zeno::reflect::relative_path_to_header_output(include_root_header_path),
+    };
+    for (const std::string& header : model.generated_headers) {
+        outputs.insert(zeno::reflect::relative_path_to_header_output(header));
+    }
+    std::string outputs_manifest;
+    for (const std::string& output : outputs) {
+        outputs_manifest += output + "\n";
+    }
+    const std::string outputs_manifest_path = get_target_outputs_manifest_path(target_name);
+    if (zeno::reflect::write_file_if_changed(outputs_manifest_path, outputs_manifest) == zeno::reflect::FileWriteResult::Failed) {
+        std::cerr << std::format("Failed to write {}", outputs_manifest_path) << std::endl;
+        return ParserErrorCode::InternalError;
+    }
+
+    const std::string generated_header_dir = zeno::reflect::get_file_path_in_header_output("reflect");
     const std::string generated_header_path = zeno::reflect::get_file_path_in_header_output("reflect/reflection.generated.hpp");
-    zeno::reflect::truncate_file(generated_header_path);
+
+    // Targets are listed by name and only what their manifests name is included, so neither directory order nor stale files reach the header
+    std::vector<std::string> target_names;
+    std::error_code err;
+    for (const auto& entry : std::filesystem::directory_iterator(generated_header_dir, err)) {
+        if (entry.is_directory(err)) {
+            target_names.push_back(entry.path().filename().string());
+        }
+    }
+    std::sort(target_names.begin(), target_names.end());
+
+    // Only the target RTTI headers, which include the per-header ones.
+    // Sources of reflected targets resolve this name to the umbrella header of their target, this one is left for everything else.
+    // Reflected headers include this one, so the generator skips the RTTI of every target without opening it.
+    std::string generated_header = "#pragma once\r\n#ifndef ZENO_REFLECT_PROCESSING\r\n";
+    for (const std::string& generated_target : target_names) {
+        const std::optional<std::string> target_outputs = zeno::reflect::read_file(get_target_outputs_manifest_path(generated_target));
+        if (!target_outputs.has_value()) {
+            continue;
+        }
+        for (std::string_view output : zeno::reflect::split(target_outputs.value(), "\n")) {
+            if (output.ends_with(".rtti.generated.hpp")) {
+                generated_header += std::format("#include \"{}\"", output) + "\r\n";
+            }
+        }
+    }
+    generated_header += "#endif\r\n";
+    if (zeno::reflect::write_file_if_changed(generated_header_path, generated_header) == zeno::reflect::FileWriteResult::Failed) {
+        std::cerr << std::format("Failed to write {}", generated_header_path) << std::endl;
+        return ParserErrorCode::InternalError;
+    }
+
+    return register_stream.finish();
+}
+
+ParserErrorCode pre_generate_reflection_model()
+{
+    // Left over from the previous request of a resident generator
+    precompiled_preamble.reset();
+    if (GLOBAL_CONTROL_FLAGS->precompiled_preamble) {
+        zeno::reflect::ProfileScope preamble_scope("preamble");
+        std::vector<std::string> no_pre_include_headers;
+        precompiled_preamble = zeno::reflect::prepare_precompiled_preamble(
+            zeno::reflect::get_parser_command_args(GLOBAL_CONTROL_FLAGS->cpp_version, GLOBAL_CONTROL_FLAGS->include_dirs, no_pre_include_headers, GLOBAL_CONTROL_FLAGS->verbose)
+        );
+    }
+
+    // Sessions of a previous request are reused unless something they looked at changed
+    const uint32_t jobs = zeno::reflect::resolve_job_count(GLOBAL_CONTROL_FLAGS->jobs);
+    size_t reused_sessions = 0;
+    for (std::unique_ptr<ParseSession>& session : parse_sessions) {
+        if (session->is_current()) {
+            ++reused_sessions;
+        } else {
+            session = std::make_unique<ParseSession>();
+        }
+    }
+    while (parse_sessions.size() < jobs) {
+        parse_sessions.push_back(std::make_unique<ParseSession>());
+    }
+    for (std::unique_ptr<ParseSession>& session : parse_sessions) {
+        session->track_files(GLOBAL_CONTROL_FLAGS->include_dirs);
+        // Hidden from the include graph of the headers, but read through the session as well
+        if (precompiled_preamble.has_value()) {
+            session->track_files({ precompiled_preamble->pch_path });
+            session->track_files(precompiled_preamble->dependencies);
+        }
+    }
+    ZENO_REFLECTION_LOG_DEBUG("[debug] Reusing {} of {} parse sessions", reused_sessions, parse_sessions.size());
 
     return ParserErrorCode::Success;
 }
@@ -116,22 +617,27 @@ TemplateSpecializationMatchCallback::TemplateSpecializationMatchCallback(Reflect
 void TemplateSpecializationMatchCallback::run(const MatchFinder::MatchResult &result)
 {
     if (const ClassTemplateSpecializationDecl* spec_decl = result.Nodes.getNodeAs<ClassTemplateSpecializationDecl>(ASTLabels::TEMPLATE_SPECIALIZATION)) {
-        const auto& template_name = spec_decl->getSpecializedTemplate()->getNameAsString();
-        if (spec_decl->getSpecializedTemplate() && template_name == "_manual_register_rtti_type_internal") {
-            auto& tArgs = spec_decl->getTemplateArgs();
-            if (tArgs.size() >= 1 && m_context) {
-                QualType type = tArgs.get(0).getAsType();
-
-                auto fb = spec_decl->field_begin();
-                std::string dispName;
-                if (fb != spec_decl->field_end()) {
-                    if (const FieldDecl* field_decl = dyn_cast<FieldDecl>(*fb); field_decl && field_decl->getAccess() == clang::AS_public) {
-                        dispName = field_decl->getNameAsString();
-                    }
-                }
+        handle(spec_decl);
+    }
+}
 
-                add_type_to_generator(m_context, type, dispName);
+void TemplateSpecializationMatchCallback::handle(const ClassTemplateSpecializationDecl *spec_decl)
+{
+    const auto& template_name = spec_decl->getSpecializedTemplate()->getNameAsString();
+    if (spec_decl->getSpecializedTemplate() && template_name == "_manual_register_rtti_type_internal") {
+        auto& tArgs = spec_decl->getTemplateArgs();
+        if (tArgs.size() >= 1 && m_context) {
+            QualType type = tArgs.get(0).getAsType();
+
+            auto fb = spec_decl->field_begin();
+            std::string dispName;
+            if (fb != spec_decl->field_end()) {
+                if (const FieldDecl* field_decl = dyn_cast<FieldDecl>(*fb); field_decl && field_decl->getAccess() == clang::AS_public) {
+                    dispName = field_decl->getNameAsString();
+                }
             }
+
+            add_type_to_generator(m_context, type, dispName);
         }
     }
 }
@@ -141,197 +647,315 @@ RecordTypeMatchCallback::RecordTypeMatchCallback(ReflectionASTConsumer *context)
 void RecordTypeMatchCallback::run(const MatchFinder::MatchResult &result)
 {
     if (const CXXRecordDecl* record_decl = result.Nodes.getNodeAs<CXXRecordDecl>(ASTLabels::RECORD_LABEL)) {
-        if (!record_decl->hasDefinition()) {
-            return;
-        }
+        handle(record_decl);
+    }
+}
 
-        inja::json metadata;
+void RecordTypeMatchCallback::handle(const CXXRecordDecl *record_decl)
+{
+    if (!record_decl->hasDefinition()) {
+        return;
+    }
 
-        if (!zeno::reflect::parse_metadata(metadata, record_decl)) {
-            return;
-        }
-        
-        // Generate rtti information
-        const clang::Type* record_type = record_decl->getTypeForDecl();
-        QualType record_qual_type(record_type, 0);
-        add_type_to_generator(m_context, record_qual_type);
-
-        
-        const std::string normalized_name = zeno::reflect::convert_to_valid_cpp_var_name(record_qual_type.getCanonicalType().getAsString());
-        bool found = false;
-        for (auto type_info : m_context->m_compiler_state.types_register_data["types"]) {
-            if (type_info["normal_name"] == normalized_name) {
-                found = true;
-                break;
-            }
-        }
+    inja::json metadata;
 
-        if (!found) {
-            inja::json type_data;
-            std::string canonical_typename_no_prefix = record_qual_type.getCanonicalType().getAsString();
-            zeno::reflect::replace_all(canonical_typename_no_prefix, "struct", "");
-            zeno::reflect::replace_all(canonical_typename_no_prefix, "class", "");
-            zeno::reflect::replace_all(canonical_typename_no_prefix, "union", "");
-            type_data["normal_name"] = normalized_name;
-            type_data["qualified_name"] = zeno::reflect::clang_type_name_no_tag(record_qual_type);
-            type_data["canonical_typename"] = record_qual_type.getCanonicalType().getAsString();
-            type_data["canonical_typename_no_prefix"] = canonical_typename_no_prefix;
-            type_data["ctors"] = inja::json::array();
-            type_data["funcs"] = inja::json::array();
-            type_data["fields"] = inja::json::array();
-            type_data["base_classes"] = inja::json::array();
-
-            type_data["metadata"] = inja::render(zeno::reflect::text::REFLECTED_METADATA, metadata);
-
-            clang::Sema& sema = m_context->m_compiler_instance.getSema();
+    if (!zeno::reflect::parse_metadata(metadata, record_decl)) {
+        return;
+    }
+
+    const size_t result_index = m_context->current_result;
+
+    // Generate rtti information
+    const clang::Type* record_type = record_decl->getTypeForDecl();
+    QualType record_qual_type(record_type, 0);
+    add_type_to_generator(m_context, record_qual_type);
+
+    
+    const std::string normalized_name = zeno::reflect::convert_to_valid_cpp_var_name(record_qual_type.getCanonicalType().getAsString());
+    if (m_context->m_compiler_state.registered_type_names.insert(normalized_name).second) {
+        ReflectedType type_data;
+        std::string canonical_typename_no_prefix = record_qual_type.getCanonicalType().getAsString();
+        zeno::reflect::replace_all(canonical_typename_no_prefix, "struct", "");
+        zeno::reflect::replace_all(canonical_typename_no_prefix, "class", "");
+        zeno::reflect::replace_all(canonical_typename_no_prefix, "union", "");
+        type_data.normal_name = normalized_name;
+        type_data.qualified_name = zeno::reflect::clang_type_name_no_tag(record_qual_type);
+        type_data.canonical_typename = record_qual_type.getCanonicalType().getAsString();
+        type_data.canonical_typename_no_prefix = canonical_typename_no_prefix;
+
+        type_data.metadata = zeno::reflect::TemplateLibrary::get().render(zeno::reflect::TemplateLibrary::get().reflected_metadata(), metadata);
+
+        clang::Sema& sema = m_context->m_compiler_instance.getSema();
+        {
+            zeno::reflect::ProfileScope implicit_members_scope("implicit_members", type_data.qualified_name);
             sema.ForceDeclarationOfImplicitMembers(const_cast<clang::CXXRecordDecl*>(record_decl));
+        }
 
-            // Processing methods
-            {
-                for (auto it = record_decl->method_begin(); it != record_decl->method_end(); ++it) {
-                    // Register all param types used
-                    if (const CXXMethodDecl* method_decl = dyn_cast<CXXMethodDecl>(*it)) {
-                        for (unsigned int i = 0; i < method_decl->getNumParams(); ++i) {
-                            const ParmVarDecl* param_decl = method_decl->getParamDecl(i);
-                            if (param_decl) {
-                                QualType type = param_decl->getType();
-                                add_type_to_generator(m_context, type);
-                            }
+        // Processing methods
+        {
+            for (auto it = record_decl->method_begin(); it != record_decl->method_end(); ++it) {
+                // Register all param types used
+                if (const CXXMethodDecl* method_decl = dyn_cast<CXXMethodDecl>(*it)) {
+                    for (unsigned int i = 0; i < method_decl->getNumParams(); ++i) {
+                        const ParmVarDecl* param_decl = method_decl->getParamDecl(i);
+                        if (param_decl) {
+                            QualType type = param_decl->getType();
+                            add_type_to_generator(m_context, type);
                         }
-                        QualType type = method_decl->getReturnType().getCanonicalType();
-                        add_type_to_generator(m_context, type);
                     }
+                    QualType type = method_decl->getReturnType().getCanonicalType();
+                    add_type_to_generator(m_context, type);
+                }
 
-                    // If is aggregate type then add list initialization as a constructor
-                    // NOTE: Empty base class optimization might lead to, a class with empty base class is a aggregate class
-                    // But if you try list initialization on it, it will be a compiler error there.
-                    if (record_decl->isAggregate() && record_decl->getNumBases() == 0 && !record_decl->hasUserDeclaredConstructor()) {
-                        inja::json ctor_data;
-                        ctor_data["is_aggregate_initialize"] = true;
-                        ctor_data["params"] = inja::json::array();
-                        for (const FieldDecl* field : record_decl->fields())  {
-                            QualType type = field->getType();
-                            ctor_data["params"].push_back(zeno::reflect::parse_param_data(field));
-                        }
-                        type_data["ctors"].push_back(ctor_data);
+                // If is aggregate type then add list initialization as a constructor
+                // NOTE: Empty base class optimization might lead to, a class with empty base class is a aggregate class
+                // But if you try list initialization on it, it will be a compiler error there.
+                if (record_decl->isAggregate() && record_decl->getNumBases() == 0 && !record_decl->hasUserDeclaredConstructor()) {
+                    ReflectedConstructor ctor_data;
+                    ctor_data.is_aggregate_initialize = true;
+                    for (const FieldDecl* field : record_decl->fields())  {
+                        QualType type = field->getType();
+                        ctor_data.params.push_back(zeno::reflect::parse_param_data(field));
                     }
+                    type_data.ctors.push_back(std::move(ctor_data));
+                }
 
-                    if (const CXXConstructorDecl* constructor_decl = dyn_cast<CXXConstructorDecl>(*it); constructor_decl && constructor_decl->getAccess() == clang::AS_public) {
-                        if (!constructor_decl->isDeleted()) {
-                            inja::json ctor_data;
-                            ctor_data["params"] = inja::json::array();
-                            for (unsigned int i = 0; i < constructor_decl->getNumParams(); ++i) {
-                                const ParmVarDecl* param_decl = constructor_decl->getParamDecl(i);
-                                inja::json param_data = zeno::reflect::parse_param_data(param_decl);
-                                ctor_data["params"].push_back(param_data);
-                            }
-                            type_data["ctors"].push_back(ctor_data);
-                        }
-                    } else if (const CXXDestructorDecl* destructor_decl = dyn_cast<CXXDestructorDecl>(*it)) {
-                    } else if (const CXXConversionDecl* conversion_decl = dyn_cast<CXXConversionDecl>(*it)) {
-                    } else if (const CXXMethodDecl* method_decl = dyn_cast<CXXMethodDecl>(*it); method_decl && method_decl->getAccess() == clang::AS_public && !method_decl->isOverloadedOperator()) {
-
-                        inja::json func_data;
-                        func_data["name"] = zeno::reflect::convert_to_valid_cpp_var_name(method_decl->getNameAsString());
-                        func_data["ret"] = method_decl->getReturnType().getCanonicalType().getAsString();
-                        func_data["params"] = inja::json::array();
-                        for (unsigned int i = 0; i < method_decl->getNumParams(); ++i) {
-                            const ParmVarDecl* param_decl = method_decl->getParamDecl(i);
-                            inja::json param_data = zeno::reflect::parse_param_data(param_decl);
-                            func_data["params"].push_back(param_data);
+                if (const CXXConstructorDecl* constructor_decl = dyn_cast<CXXConstructorDecl>(*it); constructor_decl && constructor_decl->getAccess() == clang::AS_public) {
+                    if (!constructor_decl->isDeleted()) {
+                        ReflectedConstructor ctor_data;
+                        for (unsigned int i = 0; i < constructor_decl->getNumParams(); ++i) {
+                            const ParmVarDecl* param_decl = constructor_decl->getParamDecl(i);
+                            ctor_data.params.push_back(zeno::reflect::parse_param_data(param_decl));
                         }
-                        func_data["static"] = method_decl->isStatic();
-                        func_data["const"] = method_decl->isConst();
-                        func_data["noexcept"] = method_decl->getExceptionSpecType() == clang::EST_BasicNoexcept || method_decl->getExceptionSpecType() == clang::EST_NoexceptTrue;
+                        type_data.ctors.push_back(std::move(ctor_data));
+                    }
+                } else if (const CXXDestructorDecl* destructor_decl = dyn_cast<CXXDestructorDecl>(*it)) {
+                } else if (const CXXConversionDecl* conversion_decl = dyn_cast<CXXConversionDecl>(*it)) {
+                } else if (const CXXMethodDecl* method_decl = dyn_cast<CXXMethodDecl>(*it); method_decl && method_decl->getAccess() == clang::AS_public && !method_decl->isOverloadedOperator()) {
+
+                    ReflectedFunction func_data;
+                    func_data.name = zeno::reflect::convert_to_valid_cpp_var_name(method_decl->getNameAsString());
+                    func_data.ret = method_decl->getReturnType().getCanonicalType().getAsString();
+                    for (unsigned int i = 0; i < method_decl->getNumParams(); ++i) {
+                        const ParmVarDecl* param_decl = method_decl->getParamDecl(i);
+                        func_data.params.push_back(zeno::reflect::parse_param_data(param_decl));
+                    }
+                    func_data.is_static = method_decl->isStatic();
+                    func_data.is_const = method_decl->isConst();
+                    func_data.is_noexcept = method_decl->getExceptionSpecType() == clang::EST_BasicNoexcept || method_decl->getExceptionSpecType() == clang::EST_NoexceptTrue;
 
-                        std::string method_metadata;
-                        if (zeno::reflect::parse_metadata(method_metadata, method_decl)) {
-                            func_data["metadata"] = method_metadata;
-                        }
+                    zeno::reflect::parse_metadata(func_data.metadata, method_decl);
 
-                        type_data["funcs"].push_back(func_data);
-                    }
+                    type_data.funcs.push_back(std::move(func_data));
                 }
             }
+        }
 
-            {
-                for (auto it = record_decl->field_begin(); it != record_decl->field_end(); ++it) {
-                    if (const FieldDecl* field_decl = dyn_cast<FieldDecl>(*it); field_decl && field_decl->getAccess() == clang::AS_public) {
-                        QualType type = field_decl->getType();
-                        m_context->template_header_generator->add_rtti_type(type);
-                        m_context->template_header_generator->add_rtti_type(type.getUnqualifiedType());
-
-                        inja::json field_data;
-                        field_data["name"] = field_decl->getNameAsString();
-                        field_data["type"] = type.getCanonicalType().getAsString();
-                        field_data["normal_type"] = zeno::reflect::convert_to_valid_cpp_var_name(type.getCanonicalType().getAsString());
-
-                        std::string field_metadata;
-                        if (zeno::reflect::parse_metadata(field_metadata, field_decl)) {
-                            field_data["metadata"] = field_metadata;
-                        }
+        {
+            for (auto it = record_decl->field_begin(); it != record_decl->field_end(); ++it) {
+                if (const FieldDecl* field_decl = dyn_cast<FieldDecl>(*it); field_decl && field_decl->getAccess() == clang::AS_public) {
+                    QualType type = field_decl->getType();
+                    m_context->template_header_generator->add_rtti_type(type);
 
-                        type_data["fields"].push_back(field_data);
-                    }
+                    ReflectedField field_data;
+                    field_data.name = field_decl->getNameAsString();
+                    field_data.type = type.getCanonicalType().getAsString();
+                    field_data.normal_type = zeno::reflect::convert_to_valid_cpp_var_name(type.getCanonicalType().getAsString());
+
+                    zeno::reflect::parse_metadata(field_data.metadata, field_decl);
+
+                    type_data.fields.push_back(std::move(field_data));
                 }
             }
+        }
 
-            {
-                for (auto it = record_decl->bases_begin(); it != record_decl->bases_end(); ++it) {
-                    if (const CXXBaseSpecifier* base_decl = it) {
-                        inja::json base_data;
-                        QualType type = base_decl->getType().getCanonicalType();
-                        base_data["type"] = zeno::reflect::clang_type_name_no_tag(type);
+        {
+            for (auto it = record_decl->bases_begin(); it != record_decl->bases_end(); ++it) {
+                if (const CXXBaseSpecifier* base_decl = it) {
+                    ReflectedBase base_data;
+                    QualType type = base_decl->getType().getCanonicalType();
+                    base_data.type = zeno::reflect::clang_type_name_no_tag(type);
 
-                        add_type_to_generator(m_context, type);
+                    add_type_to_generator(m_context, type);
 
-                        type_data["base_classes"].push_back(base_data);
-                    }
+                    type_data.base_classes.push_back(std::move(base_data));
                 }
             }
-
-            m_context->m_compiler_state.types_register_data["types"].push_back(type_data);
-        
         }
 
-        if (record_decl->getNumBases() > 0) {
-            for (const auto& base : record_decl->bases()) {
-            }
+        m_context->m_results[result_index].types.push_back(std::move(type_data));
+    
+    }
+
+    if (record_decl->getNumBases() > 0) {
+        for (const auto& base : record_decl->bases()) {
         }
     }
 }
 
-ReflectionASTConsumer::ReflectionASTConsumer(zeno::reflect::CodeCompilerState &state, std::string header_path, CompilerInstance &compiler)
+ReflectionASTConsumer::ReflectionASTConsumer(zeno::reflect::CodeCompilerState &state, std::span<HeaderReflectionResult> results, CompilerInstance &compiler)
     : m_compiler_state(state)
-    , m_header_path(header_path)
-    , template_header_generator(std::make_unique<zeno::reflect::TemplateHeaderGenerator>(state))
+    , m_results(results)
     , m_compiler_instance(compiler)
 {
+    for (size_t i = 0; i < m_results.size(); ++i) {
+        m_header_generators.push_back(std::make_unique<zeno::reflect::TemplateHeaderGenerator>(state));
+    }
+    template_header_generator = m_header_generators.empty() ? nullptr : m_header_generators.front().get();
     state.m_consumer = this;
 }
 
+ReflectionASTConsumer::~ReflectionASTConsumer() = default;
+
+void ReflectionASTConsumer::select_result(size_t index)
+{
+    current_result = index;
+    template_header_generator = m_header_generators[index].get();
+}
+
+std::vector<size_t> ReflectionASTConsumer::get_results_including(const clang::Decl* decl, const std::vector<std::vector<std::string>>& result_files) const
+{
+    if (m_results.size() == 1) {
+        return { 0 };
+    }
+    const SourceManager& source_manager = scoped_context->getSourceManager();
+    const FileID file_id = source_manager.getFileID(source_manager.getExpansionLoc(decl->getLocation()));
+    std::vector<size_t> indices;
+    if (auto entry = source_manager.getFileEntryRefForID(file_id)) {
+        const std::string file = zeno::reflect::normalize_path(entry->getName());
+        for (size_t i = 0; i < result_files.size(); ++i) {
+            if (std::binary_search(result_files[i].begin(), result_files[i].end(), file)) {
+                indices.push_back(i);
+            }
+        }
+    }
+    if (indices.empty()) {
+        // Not in a file of any unit, handled once like in a serial run of the first one
+        indices.push_back(0);
+    }
+    return indices;
+}
+
+/**
+ * Collects the declarations the generator cares about: annotated records and manual RTTI registrations.
+ * System headers and the std/reserved namespaces are never traversed, they can't contain either.
+*/
+class ReflectionDeclCollector : public RecursiveASTVisitor<ReflectionDeclCollector> {
+public:
+    explicit ReflectionDeclCollector(const SourceManager& source_manager) : m_source_manager(source_manager) {}
+
+    bool shouldVisitTemplateInstantiations() const { return true; }
+
+    bool TraverseDecl(Decl* decl) {
+        if (decl && !isa<TranslationUnitDecl>(decl) && should_prune(decl)) {
+            return true;
+        }
+        return RecursiveASTVisitor::TraverseDecl(decl);
+    }
+
+    bool VisitClassTemplateSpecializationDecl(ClassTemplateSpecializationDecl* spec_decl) {
+        if (const ClassTemplateDecl* template_decl = spec_decl->getSpecializedTemplate(); template_decl && template_decl->getName() == "_manual_register_rtti_type_internal") {
+            manual_rtti_registrations.push_back(spec_decl);
+        }
+        return true;
+    }
+
+    bool VisitCXXRecordDecl(CXXRecordDecl* record_decl) {
+        if (record_decl->hasAttr<AnnotateAttr>() && record_decl->hasDefinition()) {
+            records.push_back(record_decl);
+        }
+        return true;
+    }
+
+    std::vector<const ClassTemplateSpecializationDecl*> manual_rtti_registrations;
+    std::vector<const CXXRecordDecl*> records;
+
+private:
+    bool should_prune(const Decl* decl) const {
+        const SourceLocation loc = decl->getLocation();
+        if (loc.isValid() && m_source_manager.isInSystemHeader(m_source_manager.getExpansionLoc(loc))) {
+            return true;
+        }
+        if (const NamespaceDecl* namespace_decl = dyn_cast<NamespaceDecl>(decl)) {
+            // Include directories passed with -I make the standard library look like user code
+            const IdentifierInfo* identifier = namespace_decl->getIdentifier();
+            return identifier && (identifier->getName() == "std" || identifier->getName().starts_with("__"));
+        }
+        return false;
+    }
+
+    const SourceManager& m_source_manager;
+};
+
 void ReflectionASTConsumer::HandleTranslationUnit(ASTContext &context)
 {
     scoped_context = &context;
     // template_header_generator.add_rtti_type(context.VoidTy);
 
-    const std::string& gen_template_header_path = m_header_path;
-
-    MatchFinder manual_rtti_register_finder{};
-    DeclarationMatcher template_spec_matcher = classTemplateSpecializationDecl().bind(ASTLabels::TEMPLATE_SPECIALIZATION);
-    manual_rtti_register_finder.addMatcher(template_spec_matcher, template_specialization_handler.get());
-    manual_rtti_register_finder.matchAST(context);
+    const std::string identity_name = m_results.empty() ? std::string() : m_results.front().identity_name;
+    const auto match_begin = zeno::reflect::ProfileClock::now();
+    // Everything between creating the consumer and handing over the translation unit is preprocessing and parsing
+    zeno::reflect::record_profile_event("parse", identity_name, m_create_time, match_begin);
+    ReflectionDeclCollector collector(context.getSourceManager());
+    collector.TraverseDecl(context.getTranslationUnitDecl());
+    const auto match_end = zeno::reflect::ProfileClock::now();
+    zeno::reflect::record_profile_event("match", identity_name, match_begin, match_end);
+    ZENO_REFLECTION_LOG_DEBUG(
+        "[debug] Match phase of \"{}\" took {} ms, found {} annotated records and {} manual RTTI registrations",
+        identity_name,
+        std::chrono::duration_cast<std::chrono::milliseconds>(match_end - match_begin).count(),
+        collector.records.size(),
+        collector.manual_rtti_registrations.size()
+    );
+
+    // A unit gets the declarations of every file it includes, as if it was parsed alone.
+    // In a batch, files included by an earlier unit are still handed to later ones, merging de-duplicates them like in a serial run.
+    std::vector<std::vector<std::string>> result_files;
+    for (const HeaderReflectionResult& result : m_results) {
+        std::vector<std::string>& files = result_files.emplace_back(include_graph->collect_dependencies(zeno::reflect::normalize_path(result.identity_name)));
+        if (precompiled_preamble.has_value()) {
+            // Files coming from the PCH are never entered by the preprocessor, so they are added from the preamble record
+            files.push_back(zeno::reflect::normalize_path(precompiled_preamble->pch_path));
+            files.insert(files.end(), precompiled_preamble->dependencies.begin(), precompiled_preamble->dependencies.end());
+            std::sort(files.begin(), files.end());
+            files.erase(std::unique(files.begin(), files.end()), files.end());
+        }
+    }
+    std::vector<std::vector<const ClassTemplateSpecializationDecl*>> result_registrations(m_results.size());
+    std::vector<std::vector<const CXXRecordDecl*>> result_records(m_results.size());
+    for (const ClassTemplateSpecializationDecl* spec_decl : collector.manual_rtti_registrations) {
+        for (size_t index : get_results_including(spec_decl, result_files)) {
+            result_registrations[index].push_back(spec_decl);
+        }
+    }
+    for (const CXXRecordDecl* record_decl : collector.records) {
+        for (size_t index : get_results_including(record_decl, result_files)) {
+            result_records[index].push_back(record_decl);
+        }
+    }
 
-    DeclarationMatcher record_type_matcher = cxxRecordDecl().bind(ASTLabels::RECORD_LABEL);
-    MatchFinder record_finder{};
-    record_finder.addMatcher(record_type_matcher, record_type_handler.get());
-    record_finder.matchAST(context);
+    for (size_t i = 0; i < m_results.size(); ++i) {
+        select_result(i);
+        // Manual registrations of a unit go first, so their display names win over the plain RTTI emitted for its records
+        {
+            zeno::reflect::ProfileScope specializations_scope("template_specializations", m_results[i].identity_name);
+            for (const ClassTemplateSpecializationDecl* spec_decl : result_registrations[i]) {
+                template_specialization_handler->handle(spec_decl);
+            }
+        }
+        {
+            zeno::reflect::ProfileScope records_scope("records", m_results[i].identity_name);
+            for (const CXXRecordDecl* record_decl : result_records[i]) {
+                record_type_handler->handle(record_decl);
+            }
+        }
+    }
 
-    // generate header
-    const std::string generated_templates = template_header_generator->compile();
-    
-    std::ofstream generated_templates_stream(gen_template_header_path, std::ios::out | std::ios::trunc);
-    generated_templates_stream << generated_templates;
+    // The header itself is written by merge_reflection_result once all results are in
+    for (size_t i = 0; i < m_results.size(); ++i) {
+        m_results[i].rtti_blocks = m_header_generators[i]->take_rtti_blocks();
+        m_results[i].dependencies = std::move(result_files[i]);
+    }
 
     scoped_context = nullptr;
 }
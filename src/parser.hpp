@@ -1,10 +1,16 @@
 #pragma once
 
+#include <chrono>
+#include <filesystem>
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <memory>
 #include <set>
+#include <span>
 #include "metadata.hpp"
+#include "model.hpp"
+#include "inja/inja.hpp"
 #include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Tooling/Tooling.h"
 #include "clang/Tooling/CommonOptionsParser.h"
@@ -18,6 +24,7 @@ namespace reflect
 {
     struct CodeCompilerState;
     class TemplateHeaderGenerator;
+    class TypeRegisterStream;
 }
 }
 
@@ -68,11 +75,102 @@ struct ReflectionModel {
     std::string debug_name;
     std::unordered_map<std::string, ReflectionStruct> structs;
     std::set<std::string> generated_headers;
+    /// Union of the dependencies of all merged results
+    std::set<std::string> dependencies;
 };
 
-ParserErrorCode generate_reflection_model(const TranslationUnit& unit, ReflectionModel& out_model, zeno::reflect::CodeCompilerState& root_state);
-ParserErrorCode post_generate_reflection_model(const ReflectionModel& model, const zeno::reflect::CodeCompilerState& state);
+struct GeneratedRTTIBlock {
+    size_t hash = 0;
+    /// Empty for types the generator skips
+    std::string code;
+};
+
+/**
+ * Everything a single header contributes to the generated code.
+ * Results are produced independently (possibly on worker threads) and merged in input order afterwards.
+*/
+struct HeaderReflectionResult {
+    std::string identity_name;
+    std::string generated_header_path;
+    std::vector<GeneratedRTTIBlock> rtti_blocks;
+    std::vector<ReflectedType> types;
+    /// Every file the result depends on (normalized paths, sorted), including the header itself
+    std::vector<std::string> dependencies;
+};
+
+/**
+ * Include edges recorded while preprocessing, keyed by normalized file path.
+ * Files entered without an including file (pre-include headers) are roots every unit depends on.
+*/
+struct IncludeGraph {
+    std::unordered_map<std::string, std::set<std::string>> edges;
+    std::set<std::string> roots;
+
+    std::vector<std::string> collect_dependencies(const std::string& file) const;
+};
+
+/**
+ * Create preprocessor callbacks recording every entered or include-guard-skipped file into `graph`.
+*/
+std::unique_ptr<clang::PPCallbacks> create_include_graph_collector(const clang::SourceManager& source_manager, std::shared_ptr<IncludeGraph> graph);
+
+std::vector<std::string> get_generator_command_args();
+
+/**
+ * Clang file state shared by every parse of one worker, and by the runs of a resident generator.
+ * The FileManager caches stat results, file contents and directory lookups, so an include is looked up once instead of once per header.
+ * Sources read by the generator are served from an in-memory overlay. Not thread safe, each worker owns one.
+*/
+class ParseSession {
+public:
+    ParseSession();
+
+    /// Parse `code` as `file_name`, like clang::tooling::runToolOnCodeWithArgs but through the cached files
+    bool run(std::unique_ptr<clang::FrontendAction> action, const std::string& code, const std::vector<std::string>& args, const std::string& file_name);
+
+    /// Remember the modification time of `files` and of their directories, checked by is_current
+    void track_files(const std::vector<std::string>& files);
+
+    /// False once a tracked file or directory changed or the working directory is another one, the cached lookups may be stale then
+    bool is_current() const;
+
+private:
+    void reset();
+
+    llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> m_memory_files;
+    llvm::IntrusiveRefCntPtr<clang::FileManager> m_files;
+    std::string m_working_dir;
+    std::map<std::string, std::filesystem::file_time_type> m_stamps;
+};
+
+/**
+ * Session of worker `worker_id`, prepared for --jobs workers by pre_generate_reflection_model.
+*/
+ParseSession& get_parse_session(uint32_t worker_id);
+
+/**
+ * Fill `out_result` for a header skipped by the pre-scan, it gets a generated header without parsing.
+ * `scanned_files` are the files the pre-scan read, the result depends on all of them.
+*/
+void prepare_skipped_reflection_result(const TranslationUnit& unit, const std::set<std::string>& scanned_files, HeaderReflectionResult& out_result);
+ParserErrorCode generate_reflection_model(const TranslationUnit& unit, HeaderReflectionResult& out_result, zeno::reflect::CodeCompilerState& worker_state, ParseSession& session);
+/**
+ * Parse all `units` with a single clang invocation over a synthetic translation unit including each of them.
+ * Each unit gets the declarations of every file it includes and handles its manual registrations before its records, like a serial run.
+ * `out_results` must have the same size as `units`.
+*/
+ParserErrorCode generate_reflection_model_batched(std::span<const TranslationUnit> units, std::span<HeaderReflectionResult> out_results, zeno::reflect::CodeCompilerState& worker_state, ParseSession& session);
+/**
+ * Add `result` to the model and hand its types to `register_stream`, which may write them right away.
+ * Types are moved out of `result`.
+*/
+ParserErrorCode merge_reflection_result(HeaderReflectionResult& result, ReflectionModel& out_model, zeno::reflect::CodeCompilerState& root_state, zeno::reflect::TypeRegisterStream& register_stream);
+ParserErrorCode post_generate_reflection_model(const ReflectionModel& model, const zeno::reflect::CodeCompilerState& state, zeno::reflect::TypeRegisterStream& register_stream);
 ParserErrorCode pre_generate_reflection_model();
+/**
+ * Write a Makefile style depfile naming `target` as depending on every file in `dependencies`.
+*/
+bool write_depfile(const std::string& depfile_path, const std::string& target, const std::set<std::string>& dependencies);
 
 struct ASTLabels {
     inline static const char* RECORD_LABEL = "cxxRecord";
@@ -87,6 +185,7 @@ struct TemplateSpecializationMatchCallback : public clang::ast_matchers::MatchFi
     TemplateSpecializationMatchCallback(ReflectionASTConsumer* context);
 
     void run(const clang::ast_matchers::MatchFinder::MatchResult &result) override;
+    void handle(const clang::ClassTemplateSpecializationDecl* spec_decl);
 
 private:
     ReflectionASTConsumer* m_context;
@@ -96,6 +195,7 @@ struct RecordTypeMatchCallback : public clang::ast_matchers::MatchFinder::MatchC
     RecordTypeMatchCallback(ReflectionASTConsumer* context);
     
     void run(const clang::ast_matchers::MatchFinder::MatchResult &result) override;
+    void handle(const clang::CXXRecordDecl* record_decl);
 
 private:
     ReflectionASTConsumer* m_context;
@@ -103,23 +203,44 @@ private:
 
 class ReflectionASTConsumer : public clang::ASTConsumer {
 public:
-    ReflectionASTConsumer(zeno::reflect::CodeCompilerState& state, std::string header_path, clang::CompilerInstance &compiler);
+    ReflectionASTConsumer(zeno::reflect::CodeCompilerState& state, std::span<HeaderReflectionResult> results, clang::CompilerInstance &compiler);
+    ~ReflectionASTConsumer() override;
 
     void HandleTranslationUnit(clang::ASTContext &context) override;
 
     void add_type_mapping(const std::string& alias_name, clang::QualType real_name);
 
-    std::unique_ptr<zeno::reflect::TemplateHeaderGenerator> template_header_generator;
+    /**
+     * Make the result at `index` and its header generator the ones declarations are handled for.
+    */
+    void select_result(size_t index);
+
+    /// Index of the result currently being filled
+    size_t current_result = 0;
+
+    /// Header generator of the result currently being filled
+    zeno::reflect::TemplateHeaderGenerator* template_header_generator = nullptr;
+
+    /// Filled by the preprocessor callbacks registered along with this consumer
+    std::shared_ptr<IncludeGraph> include_graph = std::make_shared<IncludeGraph>();
 
     clang::ASTContext* scoped_context = nullptr;
 private:
     std::unique_ptr<RecordTypeMatchCallback> record_type_handler = std::make_unique<RecordTypeMatchCallback>(this);
     std::unique_ptr<TemplateSpecializationMatchCallback> template_specialization_handler = std::make_unique<TemplateSpecializationMatchCallback>(this);
 
+    /**
+     * Indices of the results whose header includes the file declaring `decl`, `result_files` are the sorted dependencies of each result.
+    */
+    std::vector<size_t> get_results_including(const clang::Decl* decl, const std::vector<std::vector<std::string>>& result_files) const;
+
     std::unordered_map<std::string, clang::QualType> type_name_mapping;
     zeno::reflect::CodeCompilerState& m_compiler_state;
-    std::string m_header_path;
+    std::span<HeaderReflectionResult> m_results;
+    std::vector<std::unique_ptr<zeno::reflect::TemplateHeaderGenerator>> m_header_generators;
     clang::CompilerInstance& m_compiler_instance;
+    /// Start of the parse phase reported by --time_report
+    const std::chrono::steady_clock::time_point m_create_time = std::chrono::steady_clock::now();
 
     friend struct RecordTypeMatchCallback;
 };
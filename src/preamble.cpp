@@ -0,0 +1,255 @@
+#include <fstream>
+#include <filesystem>
+#include <system_error>
+#include <mutex>
+#include <unordered_map>
+#include "preamble.hpp"
+#include "args.hpp"
+#include "log.hpp"
+#include "utils.hpp"
+#include "parser.hpp"
+#include "clang/Basic/FileManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/Tooling.h"
+
+using namespace clang;
+using namespace clang::tooling;
+
+namespace
+{
+    class PreamblePCHAction : public GeneratePCHAction {
+    public:
+        PreamblePCHAction(std::string output_path, std::shared_ptr<IncludeGraph> include_graph) : m_output_path(std::move(output_path)), m_include_graph(std::move(include_graph)) {}
+
+    protected:
+        bool BeginInvocation(CompilerInstance& compiler) override {
+            // The tooling adjusters strip "-o", so the output path is set on the invocation directly
+            compiler.getFrontendOpts().OutputFile = m_output_path;
+            return GeneratePCHAction::BeginInvocation(compiler);
+        }
+
+        bool BeginSourceFileAction(CompilerInstance& compiler) override {
+            if (!GeneratePCHAction::BeginSourceFileAction(compiler)) {
+                return false;
+            }
+            compiler.getPreprocessor().addPPCallbacks(create_include_graph_collector(compiler.getSourceManager(), m_include_graph));
+            return true;
+        }
+
+    private:
+        std::string m_output_path;
+        std::shared_ptr<IncludeGraph> m_include_graph;
+    };
+
+    class PreamblePCHActionFactory : public FrontendActionFactory {
+    public:
+        PreamblePCHActionFactory(std::string output_path, std::shared_ptr<IncludeGraph> include_graph) : m_output_path(std::move(output_path)), m_include_graph(std::move(include_graph)) {}
+
+        std::unique_ptr<FrontendAction> create() override {
+            return std::make_unique<PreamblePCHAction>(m_output_path, m_include_graph);
+        }
+
+    private:
+        std::string m_output_path;
+        std::shared_ptr<IncludeGraph> m_include_graph;
+    };
+
+    std::optional<std::vector<std::string>> read_preamble_dependencies(const std::string& deps_path)
+    {
+        std::optional<std::string> content = zeno::reflect::read_file(deps_path);
+        if (!content.has_value()) {
+            return std::nullopt;
+        }
+        std::vector<std::string> dependencies;
+        for (std::string_view line : zeno::reflect::split(content.value(), "\n")) {
+            if (!line.empty()) {
+                dependencies.emplace_back(line);
+            }
+        }
+        return dependencies;
+    }
+
+    std::string get_preamble_source()
+    {
+        std::string source;
+        for (const std::string& header : GLOBAL_CONTROL_FLAGS->pre_include_headers) {
+            if (!header.empty()) {
+                source += std::format("#include \"{}\"\n", header);
+            }
+        }
+        for (const std::string& header : GLOBAL_CONTROL_FLAGS->preamble_headers) {
+            if (!header.empty()) {
+                source += std::format("#include <{}>\n", header);
+            }
+        }
+        return source;
+    }
+
+    /**
+     * Clang validates every input file of a PCH when loading it, so a quiet probe parse tells whether the cached one is still usable.
+    */
+    bool is_preamble_usable(const std::vector<std::string>& pch_args, const std::string& probe_path)
+    {
+        std::vector<std::string> command_line { "clang-tool", "-fsyntax-only" };
+        command_line.insert(command_line.end(), pch_args.begin(), pch_args.end());
+        command_line.push_back(probe_path);
+
+        llvm::IntrusiveRefCntPtr<FileManager> files(new FileManager(FileSystemOptions(), llvm::vfs::getRealFileSystem()));
+        ToolInvocation invocation(std::move(command_line), std::make_unique<SyntaxOnlyAction>(), files.get());
+        IgnoringDiagConsumer diagnostics;
+        invocation.setDiagnosticConsumer(&diagnostics);
+        return invocation.run();
+    }
+
+    bool build_preamble(const std::vector<std::string>& base_args, const std::string& source_path, const std::string& pch_path, const std::string& deps_path)
+    {
+        std::vector<std::string> args = base_args;
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            if (args[i] == "-x") {
+                args[i + 1] = "c++-header";
+            }
+        }
+
+        // Build aside and rename, other generator processes might be loading the same entry
+        const std::string temp_pch_path = make_temp_path(pch_path);
+        FixedCompilationDatabase compilations(".", args);
+        ClangTool tool(compilations, { source_path });
+        auto include_graph = std::make_shared<IncludeGraph>();
+        PreamblePCHActionFactory factory(temp_pch_path, include_graph);
+        std::error_code err;
+        if (tool.run(&factory) != 0) {
+            std::filesystem::remove(temp_pch_path, err);
+            return false;
+        }
+
+        // Dependencies go first, a PCH without its dependency list is never reused
+        std::string dependencies;
+        for (const std::string& dependency : include_graph->collect_dependencies(zeno::reflect::normalize_path(source_path))) {
+            dependencies += dependency + "\n";
+        }
+        if (!zeno::reflect::write_file_atomically(deps_path, dependencies)) {
+            std::filesystem::remove(temp_pch_path, err);
+            return false;
+        }
+
+        std::filesystem::rename(temp_pch_path, pch_path, err);
+        if (err) {
+            std::filesystem::remove(temp_pch_path, err);
+            return false;
+        }
+        return true;
+    }
+
+    using FileStamps = std::vector<std::pair<std::string, std::filesystem::file_time_type>>;
+
+    FileStamps stamp_files(const std::string& pch_path, const std::vector<std::string>& dependencies)
+    {
+        FileStamps stamps;
+        stamps.reserve(dependencies.size() + 1);
+        std::error_code err;
+        stamps.emplace_back(pch_path, std::filesystem::last_write_time(pch_path, err));
+        for (const std::string& dependency : dependencies) {
+            stamps.emplace_back(dependency, std::filesystem::last_write_time(dependency, err));
+        }
+        return stamps;
+    }
+
+    bool are_stamps_current(const FileStamps& stamps)
+    {
+        for (const auto& [path, write_time] : stamps) {
+            std::error_code err;
+            if (std::filesystem::last_write_time(path, err) != write_time || err) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    struct ResidentPreamble {
+        zeno::reflect::PrecompiledPreamble preamble;
+        FileStamps stamps;
+    };
+
+    /**
+     * Preambles prepared earlier in this process, keyed by their PCH path.
+     * A resident generator reuses them while the PCH and every file it was built from keep their modification time,
+     * which is much cheaper than the probe parse done by is_preamble_usable.
+    */
+    std::mutex resident_preambles_mutex;
+    std::unordered_map<std::string, ResidentPreamble> resident_preambles;
+
+    std::optional<zeno::reflect::PrecompiledPreamble> remember_preamble(std::optional<zeno::reflect::PrecompiledPreamble> preamble)
+    {
+        if (preamble.has_value()) {
+            std::lock_guard lock(resident_preambles_mutex);
+            resident_preambles.insert_or_assign(preamble->pch_path, ResidentPreamble { preamble.value(), stamp_files(preamble->pch_path, preamble->dependencies) });
+        }
+        return preamble;
+    }
+}
+
+std::optional<zeno::reflect::PrecompiledPreamble> zeno::reflect::prepare_precompiled_preamble(const std::vector<std::string>& base_args)
+{
+    const std::string source = get_preamble_source();
+    if (source.empty()) {
+        return std::nullopt;
+    }
+
+    // Pre-include headers are project headers, their stamps are part of the key so an edit produces a new entry
+    std::string key_source = source;
+    for (const std::string& arg : base_args) {
+        key_source += arg + "\n";
+    }
+    for (const std::string& header : GLOBAL_CONTROL_FLAGS->pre_include_headers) {
+        std::error_code err;
+        const auto size = std::filesystem::file_size(header, err);
+        const auto mtime = std::filesystem::last_write_time(header, err);
+        key_source += std::format("{}:{}:{}\n", header, size, mtime.time_since_epoch().count());
+    }
+    const std::string key = std::format("{:016x}", FNV1aHash{}(key_source));
+
+    const std::filesystem::path cache_dir = get_cache_dir();
+    mkdirs(cache_dir.string());
+    const std::string source_path = (cache_dir / std::format("preamble-{}.hpp", key)).string();
+    const std::string pch_path = (cache_dir / std::format("preamble-{}.pch", key)).string();
+    const std::string deps_path = (cache_dir / std::format("preamble-{}.deps", key)).string();
+
+    {
+        std::lock_guard lock(resident_preambles_mutex);
+        if (auto it = resident_preambles.find(pch_path); it != resident_preambles.end()) {
+            if (are_stamps_current(it->second.stamps)) {
+                ZENO_REFLECTION_LOG_DEBUG("[debug] Reusing resident precompiled preamble \"{}\"", it->second.preamble.pch_path);
+                return it->second.preamble;
+            }
+            resident_preambles.erase(it);
+        }
+    }
+
+    // The source is only written once, rewriting it would invalidate PCHs loaded by other processes
+    if (!std::filesystem::exists(source_path)) {
+        zeno::reflect::write_file_atomically(source_path, source);
+    }
+
+    std::vector<std::string> pch_args = base_args;
+    pch_args.push_back("-include-pch");
+    pch_args.push_back(pch_path);
+
+    if (std::filesystem::exists(pch_path) && is_preamble_usable(pch_args, source_path)) {
+        if (std::optional<std::vector<std::string>> dependencies = read_preamble_dependencies(deps_path)) {
+            ZENO_REFLECTION_LOG_DEBUG("[debug] Reusing precompiled preamble \"{}\"", pch_path);
+            return remember_preamble(PrecompiledPreamble { pch_path, std::move(dependencies.value()) });
+        }
+    }
+
+    ZENO_REFLECTION_LOG_DEBUG("[debug] Building precompiled preamble \"{}\"", pch_path);
+    if (!build_preamble(base_args, source_path, pch_path, deps_path)) {
+        std::cerr << std::format("Failed to build precompiled preamble {}, falling back to pre-include headers", pch_path) << std::endl;
+        return std::nullopt;
+    }
+    if (std::optional<std::vector<std::string>> dependencies = read_preamble_dependencies(deps_path)) {
+        return remember_preamble(PrecompiledPreamble { pch_path, std::move(dependencies.value()) });
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+
+namespace zeno
+{
+namespace reflect
+{
+    struct PrecompiledPreamble {
+        std::string pch_path;
+        /// Files the PCH was built from (normalized, sorted), they are hidden from the include graph of headers using it
+        std::vector<std::string> dependencies;
+    };
+
+    /**
+     * Build a precompiled header from the pre-include headers and `--preamble_header`s, or reuse it from the cache directory.
+     * `base_args` are the parser arguments without any `-include`, the cache entry is keyed on them.
+     * Returns nullopt if the PCH can't be built, callers should keep using `-include` in that case.
+    */
+    std::optional<PrecompiledPreamble> prepare_precompiled_preamble(const std::vector<std::string>& base_args);
+}
+}
@@ -0,0 +1,194 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "prescan.hpp"
+
+namespace
+{
+    /// Annotation macros of reflect/core.hpp, the attribute they expand to and the manual registrations of reflect/registry.hpp
+    constexpr std::string_view REFLECTION_MARKERS[] = {
+        "ZRECORD", "ZPROPERTY", "ZMETHOD", "ZNODE", "ZENO_ANNOTATE", "annotate",
+        "REFLECT_REGISTER_RTTI_TYPE", "_manual_register_rtti_type_internal<",
+    };
+
+    bool contains_marker(std::string_view text)
+    {
+        for (std::string_view marker : REFLECTION_MARKERS) {
+            if (text.find(marker) != std::string_view::npos) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool is_identifier_char(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    std::string_view skip_spaces(std::string_view text)
+    {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+            text.remove_prefix(1);
+        }
+        return text;
+    }
+
+    std::string_view take_identifier(std::string_view& text)
+    {
+        size_t length = 0;
+        while (length < text.size() && is_identifier_char(text[length])) {
+            ++length;
+        }
+        std::string_view identifier = text.substr(0, length);
+        text.remove_prefix(length);
+        return identifier;
+    }
+
+    /// Same spelling as normalize_path, the paths end up in the dependencies of results
+    std::string normalize(const std::filesystem::path& path)
+    {
+        std::error_code err;
+        std::filesystem::path absolute_path = std::filesystem::absolute(path, err);
+        if (err) {
+            absolute_path = path;
+        }
+        return absolute_path.lexically_normal().generic_string();
+    }
+
+    std::optional<std::string> read_text(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            return std::nullopt;
+        }
+        std::stringstream buf;
+        buf << file.rdbuf();
+        return buf.str();
+    }
+}
+
+zeno::reflect::ReflectionMarkerPrescan::ReflectionMarkerPrescan(std::vector<std::string> include_dirs)
+    : m_include_dirs(std::move(include_dirs))
+{
+}
+
+bool zeno::reflect::ReflectionMarkerPrescan::has_reflection_markers(const std::string& path, std::string_view source, std::set<std::string>& out_files)
+{
+    // Collect every reachable file first, a macro defined in one of them may be used in any other
+    const std::string root = normalize(path);
+    std::vector<const ScannedFile*> files;
+    std::vector<std::string> pending { root };
+    std::set<std::string> visited;
+    while (!pending.empty()) {
+        std::string current = std::move(pending.back());
+        pending.pop_back();
+        if (!visited.insert(current).second) {
+            continue;
+        }
+
+        const ScannedFile* file = nullptr;
+        if (auto it = m_files.find(current); it != m_files.end()) {
+            file = &it->second;
+        } else if (current == root) {
+            file = &scan(current, source);
+        } else if (std::optional<std::string> text = read_text(current)) {
+            file = &scan(current, text.value());
+        } else {
+            continue;
+        }
+        out_files.insert(current);
+        files.push_back(file);
+        pending.insert(pending.end(), file->includes.begin(), file->includes.end());
+    }
+
+    std::vector<std::string_view> marker_macros;
+    for (const ScannedFile* file : files) {
+        if (contains_marker(file->body)) {
+            return true;
+        }
+        marker_macros.insert(marker_macros.end(), file->marker_macros.begin(), file->marker_macros.end());
+    }
+    for (const ScannedFile* file : files) {
+        for (std::string_view macro : marker_macros) {
+            if (file->body.find(macro) != std::string::npos) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+const zeno::reflect::ReflectionMarkerPrescan::ScannedFile& zeno::reflect::ReflectionMarkerPrescan::scan(const std::string& path, std::string_view source)
+{
+    ScannedFile& file = m_files[path];
+
+    size_t line_begin = 0;
+    while (line_begin < source.size()) {
+        // Directives continue over lines ending with a backslash
+        size_t line_end = line_begin;
+        while (true) {
+            line_end = source.find('\n', line_end);
+            if (line_end == std::string_view::npos) {
+                line_end = source.size();
+                break;
+            }
+            size_t last = line_end;
+            if (last > line_begin && source[last - 1] == '\r') {
+                --last;
+            }
+            if (last == line_begin || source[last - 1] != '\\') {
+                break;
+            }
+            ++line_end;
+        }
+        const std::string_view line = source.substr(line_begin, line_end - line_begin);
+        line_begin = line_end + 1;
+
+        std::string_view directive = skip_spaces(line);
+        if (!directive.starts_with('#')) {
+            file.body.append(line);
+            file.body.push_back('\n');
+            continue;
+        }
+        directive = skip_spaces(directive.substr(1));
+        const std::string_view name = take_identifier(directive);
+        directive = skip_spaces(directive);
+        if (name == "define") {
+            const std::string_view macro = take_identifier(directive);
+            if (!macro.empty() && contains_marker(directive)) {
+                file.marker_macros.emplace_back(macro);
+            }
+        } else if (name == "include" && (directive.starts_with('"') || directive.starts_with('<'))) {
+            const bool quoted = directive.starts_with('"');
+            const size_t close = directive.find(quoted ? '"' : '>', 1);
+            if (close != std::string_view::npos) {
+                if (std::optional<std::string> resolved = resolve_include(path, directive.substr(1, close - 1), quoted)) {
+                    file.includes.push_back(std::move(resolved.value()));
+                }
+            }
+        } else {
+            file.body.append(line);
+            file.body.push_back('\n');
+        }
+    }
+    return file;
+}
+
+std::optional<std::string> zeno::reflect::ReflectionMarkerPrescan::resolve_include(const std::string& includer, std::string_view include, bool quoted) const
+{
+    std::error_code err;
+    if (quoted) {
+        const std::filesystem::path next_to_includer = std::filesystem::path(includer).parent_path() / include;
+        if (std::filesystem::is_regular_file(next_to_includer, err)) {
+            return normalize(next_to_includer);
+        }
+    }
+    for (const std::string& include_dir : m_include_dirs) {
+        const std::filesystem::path candidate = std::filesystem::path(include_dir) / include;
+        if (std::filesystem::is_regular_file(candidate, err)) {
+            return normalize(candidate);
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace zeno
+{
+namespace reflect
+{
+    /**
+     * Cheap textual check for the macros and attributes the generator reacts to, in an input header and every header it includes.
+     * Quoted includes are resolved next to the including file, then in the include dirs, includes with angle brackets only in the include dirs.
+     * Includes which resolve nowhere (e.g. standard headers) are not followed.
+     * Marker names inside #define directives don't count, but a macro defined with a marker counts as a marker itself.
+     * False positives (e.g. a macro named in a comment) only cost a parse, a header without any of them has nothing to reflect.
+     * Each file is read once per run however many input headers include it.
+    */
+    class ReflectionMarkerPrescan {
+    public:
+        explicit ReflectionMarkerPrescan(std::vector<std::string> include_dirs);
+
+        /**
+         * True if the header at `path` with content `source` may contain something to reflect.
+         * Every file read for it, including `path`, is added to `out_files` as a normalized path.
+        */
+        bool has_reflection_markers(const std::string& path, std::string_view source, std::set<std::string>& out_files);
+
+    private:
+        struct ScannedFile {
+            /// Text outside #define directives
+            std::string body;
+            /// Macros whose definition contains a marker
+            std::vector<std::string> marker_macros;
+            /// Normalized paths of the includes which could be resolved
+            std::vector<std::string> includes;
+        };
+
+        const ScannedFile& scan(const std::string& path, std::string_view source);
+        std::optional<std::string> resolve_include(const std::string& includer, std::string_view include, bool quoted) const;
+
+        std::vector<std::string> m_include_dirs;
+        std::map<std::string, ScannedFile> m_files;
+    };
+}
+}
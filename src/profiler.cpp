@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <format>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "profiler.hpp"
+#include "args.hpp"
+#include "utils.hpp"
+#include "inja/inja.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    struct ProfileEvent {
+        std::string_view phase;
+        std::string detail;
+        uint32_t thread_index;
+        zeno::reflect::ProfileClock::time_point begin;
+        zeno::reflect::ProfileClock::time_point end;
+    };
+
+    struct ProfileRecorder {
+        std::mutex mutex;
+        std::vector<ProfileEvent> events;
+        std::map<std::thread::id, uint32_t> thread_indices;
+    };
+
+    ProfileRecorder& get_recorder()
+    {
+        static ProfileRecorder recorder;
+        return recorder;
+    }
+
+    double to_milliseconds(zeno::reflect::ProfileClock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    int64_t to_microseconds(zeno::reflect::ProfileClock::duration duration)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    }
+
+    /// Peak resident set size of the process so far, a resident generator reports the peak over all its requests
+    std::optional<size_t> get_peak_rss_bytes()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters {};
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return std::nullopt;
+        }
+        return counters.PeakWorkingSetSize;
+#else
+        rusage usage {};
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return std::nullopt;
+        }
+#ifdef __APPLE__
+        return static_cast<size_t>(usage.ru_maxrss);
+#else
+        // Linux reports kilobytes
+        return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+
+    void print_time_report(const std::vector<ProfileEvent>& events)
+    {
+        struct PhaseTotal {
+            zeno::reflect::ProfileClock::duration total {};
+            zeno::reflect::ProfileClock::duration max {};
+            size_t count = 0;
+        };
+        // Phases in order of first appearance, which follows the pipeline
+        std::vector<std::pair<std::string_view, PhaseTotal>> phases;
+        std::map<std::string, zeno::reflect::ProfileClock::duration> headers;
+        for (const ProfileEvent& event : events) {
+            auto it = std::find_if(phases.begin(), phases.end(), [&event](const auto& phase) { return phase.first == event.phase; });
+            if (it == phases.end()) {
+                it = phases.insert(phases.end(), { event.phase, PhaseTotal{} });
+            }
+            const auto duration = event.end - event.begin;
+            it->second.total += duration;
+            it->second.max = std::max(it->second.max, duration);
+            ++it->second.count;
+            if (event.phase == "header") {
+                headers[event.detail] += duration;
+            }
+        }
+
+        std::vector<std::pair<std::string, zeno::reflect::ProfileClock::duration>> sorted_headers(headers.begin(), headers.end());
+        std::stable_sort(sorted_headers.begin(), sorted_headers.end(), [](const auto& lhs, const auto& rhs) { return lhs.second > rhs.second; });
+
+        std::cout << std::format("[{}] Reflection generator time report (phases are summed over jobs)\n", GLOBAL_CONTROL_FLAGS->target_name);
+        std::cout << std::format("  {:<26}{:>12}{:>8}{:>12}\n", "phase", "total ms", "count", "max ms");
+        for (const auto& [phase, total] : phases) {
+            std::cout << std::format("  {:<26}{:>12.1f}{:>8}{:>12.1f}\n", phase, to_milliseconds(total.total), total.count, to_milliseconds(total.max));
+        }
+        if (const std::optional<size_t> peak_rss = get_peak_rss_bytes()) {
+            std::cout << std::format("  peak resident memory {:.1f} MiB\n", static_cast<double>(peak_rss.value()) / (1024.0 * 1024.0));
+        }
+        std::cout << std::format("  {} headers, slowest first:\n", sorted_headers.size());
+        for (const auto& [header, duration] : sorted_headers) {
+            std::cout << std::format("  {:>10.1f} ms  {}\n", to_milliseconds(duration), header);
+        }
+        std::cout.flush();
+    }
+
+    bool write_trace(const std::string& path, const std::vector<ProfileEvent>& events)
+    {
+        // Timestamps are relative to the earliest event, events are sorted by their begin
+        const zeno::reflect::ProfileClock::time_point origin = events.empty() ? zeno::reflect::ProfileClock::time_point{} : events.front().begin;
+        inja::json trace_events = inja::json::array();
+        for (const ProfileEvent& event : events) {
+            inja::json trace_event;
+            trace_event["name"] = event.phase;
+            trace_event["cat"] = "generator";
+            trace_event["ph"] = "X";
+            trace_event["ts"] = to_microseconds(event.begin - origin);
+            trace_event["dur"] = to_microseconds(event.end - event.begin);
+            trace_event["pid"] = 1;
+            trace_event["tid"] = event.thread_index;
+            if (!event.detail.empty()) {
+                trace_event["args"]["detail"] = event.detail;
+            }
+            trace_events.push_back(std::move(trace_event));
+        }
+
+        inja::json root;
+        root["traceEvents"] = std::move(trace_events);
+        root["displayTimeUnit"] = "ms";
+        root["otherData"]["target"] = GLOBAL_CONTROL_FLAGS->target_name;
+        return zeno::reflect::write_file_atomically(path, root.dump());
+    }
+}
+
+bool zeno::reflect::is_profiling_enabled()
+{
+    return nullptr != GLOBAL_CONTROL_FLAGS && (GLOBAL_CONTROL_FLAGS->time_report || !GLOBAL_CONTROL_FLAGS->trace_out.empty());
+}
+
+void zeno::reflect::record_profile_event(std::string_view phase, std::string_view detail, ProfileClock::time_point begin, ProfileClock::time_point end)
+{
+    if (!is_profiling_enabled()) {
+        return;
+    }
+
+    ProfileRecorder& recorder = get_recorder();
+    std::lock_guard lock(recorder.mutex);
+    const auto [it, _] = recorder.thread_indices.try_emplace(std::this_thread::get_id(), static_cast<uint32_t>(recorder.thread_indices.size()));
+    recorder.events.push_back({ phase, std::string(detail), it->second, begin, end });
+}
+
+zeno::reflect::ProfileScope::ProfileScope(std::string_view phase, std::string_view detail)
+    : m_phase(phase)
+{
+    if (is_profiling_enabled()) {
+        m_detail = detail;
+        m_begin = ProfileClock::now();
+    }
+}
+
+zeno::reflect::ProfileScope::~ProfileScope()
+{
+    if (m_begin.has_value()) {
+        record_profile_event(m_phase, m_detail, m_begin.value(), ProfileClock::now());
+    }
+}
+
+bool zeno::reflect::write_profile_outputs()
+{
+    if (!is_profiling_enabled()) {
+        return true;
+    }
+
+    // Events are handed over, a resident generator starts each request with an empty recording
+    ProfileRecorder& recorder = get_recorder();
+    std::vector<ProfileEvent> events;
+    {
+        std::lock_guard lock(recorder.mutex);
+        events.swap(recorder.events);
+        recorder.thread_indices.clear();
+    }
+    // Workers record in completion order, the report and the trace read better in start order
+    std::stable_sort(events.begin(), events.end(), [](const ProfileEvent& lhs, const ProfileEvent& rhs) { return lhs.begin < rhs.begin; });
+
+    if (GLOBAL_CONTROL_FLAGS->time_report) {
+        print_time_report(events);
+    }
+    if (!GLOBAL_CONTROL_FLAGS->trace_out.empty() && !write_trace(GLOBAL_CONTROL_FLAGS->trace_out, events)) {
+        std::cerr << std::format("Failed to write trace {}", GLOBAL_CONTROL_FLAGS->trace_out) << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace zeno
+{
+namespace reflect
+{
+    using ProfileClock = std::chrono::steady_clock;
+
+    /// True when --time_report or --trace_out asked for phase timings
+    bool is_profiling_enabled();
+
+    /**
+     * Record a finished phase. `phase` must be a literal, `detail` names the header or file it worked on.
+     * Safe to call from worker threads.
+    */
+    void record_profile_event(std::string_view phase, std::string_view detail, ProfileClock::time_point begin, ProfileClock::time_point end);
+
+    /// Records its own lifetime as a phase, costs nothing but a flag check while profiling is disabled
+    class ProfileScope {
+    public:
+        explicit ProfileScope(std::string_view phase, std::string_view detail = {});
+        ~ProfileScope();
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        std::string_view m_phase;
+        std::string m_detail;
+        std::optional<ProfileClock::time_point> m_begin;
+    };
+
+    /**
+     * Print the per-phase and per-header summary for --time_report and write the Chrome trace for --trace_out.
+     * Returns false if the trace couldn't be written.
+    */
+    bool write_profile_outputs();
+}
+}
@@ -0,0 +1,74 @@
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include "project.hpp"
+#include "driver.hpp"
+#include "parser.hpp"
+#include "utils.hpp"
+#include "inja/inja.hpp"
+
+namespace
+{
+    std::vector<std::string> get_string_array(const inja::json& object, const char* key)
+    {
+        std::vector<std::string> strings;
+        if (auto it = object.find(key); it != object.end() && it->is_array()) {
+            for (const inja::json& value : *it) {
+                strings.push_back(value.get<std::string>());
+            }
+        }
+        return strings;
+    }
+}
+
+int zeno::reflect::run_reflection_project(const ManifestFlags& flags, const char* generator_path)
+{
+    std::optional<std::string> manifest_text = read_file(flags.manifest);
+    if (!manifest_text.has_value()) {
+        std::cerr << std::format("Can't read manifest {}", flags.manifest) << std::endl;
+        return 2;
+    }
+    inja::json manifest = inja::json::parse(manifest_text.value(), nullptr, false);
+    if (manifest.is_discarded() || !manifest.contains("targets") || !manifest["targets"].is_array()) {
+        std::cerr << std::format("Manifest {} must be a JSON object with a \"targets\" array", flags.manifest) << std::endl;
+        return 2;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    const std::vector<std::string> common_args = get_string_array(manifest, "common_args");
+    std::set<std::string> dependencies;
+    int32_t result = 0;
+    size_t target_count = 0;
+    for (const inja::json& target : manifest["targets"]) {
+        std::vector<std::string> args { generator_path };
+        args.insert(args.end(), common_args.begin(), common_args.end());
+        const std::vector<std::string> target_args = get_string_array(target, "args");
+        args.insert(args.end(), target_args.begin(), target_args.end());
+
+        try {
+            ControlFlags target_flags = parse_args(args);
+            GLOBAL_CONTROL_FLAGS = &target_flags;
+            result += run_reflection_generator(&dependencies);
+        } catch (const std::exception& e) {
+            std::cerr << std::format("Invalid arguments for target {} in {}: {}", target.value("target", std::string()), flags.manifest, e.what()) << std::endl;
+            result += 2;
+        }
+        GLOBAL_CONTROL_FLAGS = nullptr;
+        ++target_count;
+    }
+
+    if (!flags.depfile.empty()) {
+        // The manifest itself is an input, a target added to it must trigger a new run
+        dependencies.insert(normalize_path(flags.manifest));
+        const std::string& depfile_target = flags.depfile_target.empty() ? flags.manifest : flags.depfile_target;
+        if (!write_depfile(flags.depfile, depfile_target, dependencies)) {
+            std::cerr << std::format("Failed to write depfile {}", flags.depfile) << std::endl;
+        }
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    std::cout << std::format("Generated reflection of {} targets in {} ms", target_count, std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()) << std::endl;
+    return result;
+}
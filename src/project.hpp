@@ -0,0 +1,17 @@
+#pragma once
+
+#include "args.hpp"
+
+namespace zeno
+{
+namespace reflect
+{
+    /**
+     * Generate every target listed in `--manifest` within this process.
+     * Targets run one after another, each with its full `--jobs` parallelism, and share what a resident generator shares across requests:
+     * LLVM initialization, parsed templates and precompiled preambles of targets with the same parser arguments.
+     * Returns the summed error codes of all targets.
+    */
+    int run_reflection_project(const ManifestFlags& flags, const char* generator_path);
+}
+}
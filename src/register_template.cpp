@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "register_template.hpp"
+
+namespace
+{
+    /**
+     * Names a part of the register template reads and binds, and the statements it can't be split with.
+    */
+    class RegisterTemplateScan : public inja::NodeVisitor {
+    public:
+        /// `scope` holds the variables of the loops the part is rendered in
+        explicit RegisterTemplateScan(std::vector<std::string> scope = {})
+            : m_scope(std::move(scope))
+        {
+        }
+
+        /// First segments of the data read outside the part's own loops, string literals count since `exists("types")` names data too
+        std::set<std::string> free_names;
+        /// Variables of the loops inside the part, they stay in the render state once their loop ends
+        std::set<std::string> bound_names;
+        /// `loop` read with fewer `parent`s than enclosing loops of the part, i.e. the loop object of a loop outside of it
+        bool reads_outer_loop = false;
+        bool has_unsupported_statement = false;
+
+        void visit(const inja::BlockNode& node) override
+        {
+            for (const std::shared_ptr<inja::AstNode>& child : node.nodes) {
+                child->accept(*this);
+            }
+        }
+
+        void visit(const inja::TextNode&) override {}
+        void visit(const inja::ExpressionNode&) override {}
+
+        void visit(const inja::LiteralNode& node) override
+        {
+            if (node.value.is_string()) {
+                add_read(node.value.get_ref<const std::string&>());
+            }
+        }
+
+        void visit(const inja::DataNode& node) override
+        {
+            add_read(node.name);
+        }
+
+        void visit(const inja::FunctionNode& node) override
+        {
+            for (const std::shared_ptr<inja::ExpressionNode>& argument : node.arguments) {
+                argument->accept(*this);
+            }
+        }
+
+        void visit(const inja::ExpressionListNode& node) override
+        {
+            if (node.root) {
+                node.root->accept(*this);
+            }
+        }
+
+        void visit(const inja::StatementNode&) override {}
+        void visit(const inja::ForStatementNode&) override {}
+
+        void visit(const inja::ForArrayStatementNode& node) override
+        {
+            node.condition.accept(*this);
+            visit_loop_body(node.body, { node.value });
+        }
+
+        void visit(const inja::ForObjectStatementNode& node) override
+        {
+            node.condition.accept(*this);
+            visit_loop_body(node.body, { node.key, node.value });
+        }
+
+        void visit(const inja::IfStatementNode& node) override
+        {
+            node.condition.accept(*this);
+            node.true_statement.accept(*this);
+            node.false_statement.accept(*this);
+        }
+
+        void visit(const inja::IncludeStatementNode&) override { has_unsupported_statement = true; }
+        void visit(const inja::ExtendsStatementNode&) override { has_unsupported_statement = true; }
+        void visit(const inja::BlockStatementNode&) override { has_unsupported_statement = true; }
+        void visit(const inja::SetStatementNode&) override { has_unsupported_statement = true; }
+
+    private:
+        void visit_loop_body(const inja::BlockNode& body, const std::vector<std::string>& variables)
+        {
+            bound_names.insert(variables.begin(), variables.end());
+            m_scope.insert(m_scope.end(), variables.begin(), variables.end());
+            ++m_loop_depth;
+            body.accept(*this);
+            --m_loop_depth;
+            m_scope.resize(m_scope.size() - variables.size());
+        }
+
+        void add_read(std::string_view name)
+        {
+            const std::string_view root = name.substr(0, name.find('.'));
+            if (root == "loop") {
+                // `loop.parent.index` is the loop object one level out
+                size_t parents = 0;
+                std::string_view rest = name.substr(root.size());
+                constexpr std::string_view parent = ".parent";
+                while (rest.substr(0, parent.size()) == parent && (rest.size() == parent.size() || rest[parent.size()] == '.')) {
+                    rest.remove_prefix(parent.size());
+                    ++parents;
+                }
+                if (parents >= m_loop_depth) {
+                    reads_outer_loop = true;
+                }
+                return;
+            }
+            if (std::find(m_scope.begin(), m_scope.end(), root) == m_scope.end()) {
+                free_names.emplace(root);
+            }
+        }
+
+        std::vector<std::string> m_scope;
+        size_t m_loop_depth = 0;
+    };
+
+    bool intersects(const std::set<std::string>& a, const std::set<std::string>& b)
+    {
+        return std::any_of(a.begin(), a.end(), [&b] (const std::string& name) { return b.contains(name); });
+    }
+
+    inja::Template make_part(const inja::Template& tmpl, size_t begin, size_t end)
+    {
+        inja::Template part(tmpl.content);
+        part.root.nodes.assign(tmpl.root.nodes.begin() + begin, tmpl.root.nodes.begin() + end);
+        return part;
+    }
+}
+
+std::optional<zeno::reflect::SplitRegisterTemplate> zeno::reflect::split_register_template(const inja::Template& tmpl)
+{
+    const std::vector<std::shared_ptr<inja::AstNode>>& nodes = tmpl.root.nodes;
+    const inja::ForArrayStatementNode* types_loop = nullptr;
+    size_t loop_index = 0;
+    for (; loop_index < nodes.size(); ++loop_index) {
+        const auto* loop = dynamic_cast<const inja::ForArrayStatementNode*>(nodes[loop_index].get());
+        const auto* condition = loop != nullptr ? dynamic_cast<const inja::DataNode*>(loop->condition.root.get()) : nullptr;
+        if (condition != nullptr && condition->name == "types") {
+            types_loop = loop;
+            break;
+        }
+    }
+    if (nullptr == types_loop) {
+        return std::nullopt;
+    }
+
+    SplitRegisterTemplate result {
+        make_part(tmpl, 0, loop_index),
+        make_part(tmpl, loop_index, loop_index + 1),
+        make_part(tmpl, loop_index + 1, nodes.size()),
+    };
+
+    RegisterTemplateScan prelude_scan;
+    result.prelude.root.accept(prelude_scan);
+    RegisterTemplateScan body_scan({ types_loop->value });
+    types_loop->body.accept(body_scan);
+    RegisterTemplateScan epilogue_scan;
+    result.epilogue.root.accept(epilogue_scan);
+
+    for (const RegisterTemplateScan* scan : { &prelude_scan, &body_scan, &epilogue_scan }) {
+        if (scan->has_unsupported_statement || scan->free_names.contains("types")) {
+            return std::nullopt;
+        }
+    }
+    // The prelude renders first in both cases, the body and the epilogue must not see what the earlier parts left behind
+    std::set<std::string> section_bound_names = body_scan.bound_names;
+    section_bound_names.insert(types_loop->value);
+    if (body_scan.reads_outer_loop || epilogue_scan.reads_outer_loop
+        || intersects(body_scan.free_names, prelude_scan.bound_names)
+        || intersects(epilogue_scan.free_names, prelude_scan.bound_names)
+        || intersects(epilogue_scan.free_names, section_bound_names)) {
+        return std::nullopt;
+    }
+    return result;
+}
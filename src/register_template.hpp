@@ -0,0 +1,31 @@
+#pragma once
+
+#include <optional>
+#include "inja/inja.hpp"
+
+namespace zeno
+{
+namespace reflect
+{
+    /**
+     * Register template cut around its top level `for <var> in types` loop.
+     * The parts keep the nodes and source text of the parsed template, so comments and whitespace control are already applied.
+    */
+    struct SplitRegisterTemplate {
+        inja::Template prelude;
+        /// The loop alone, rendered with `types` holding a single type it gives the section of that type
+        inja::Template type_section;
+        inja::Template epilogue;
+    };
+
+    /**
+     * Split `tmpl` so the sections of the types can be rendered independently, nullopt if that could change the output:
+     * - the loop must be the only use of `types`, the parts are rendered without it,
+     * - its body must not read the loop object of that loop (every type would see index 0),
+     * - no part may read a loop variable left over from an earlier part,
+     * - `set`, `include`, `extends` and `block` are rejected, they carry state or render text that isn't inspected.
+     * The prelude, the sections of the types in order and the epilogue concatenated equal a render of the whole template.
+    */
+    std::optional<SplitRegisterTemplate> split_register_template(const inja::Template& tmpl);
+}
+}
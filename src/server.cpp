@@ -0,0 +1,271 @@
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "server.hpp"
+#include "server_protocol.hpp"
+#include "driver.hpp"
+#include "log.hpp"
+#include "llvm/Support/raw_ostream.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+
+namespace
+{
+    std::optional<sockaddr_un> make_socket_address(const std::string& socket_path)
+    {
+        sockaddr_un address {};
+        if (socket_path.size() >= sizeof(address.sun_path)) {
+            return std::nullopt;
+        }
+        address.sun_family = AF_UNIX;
+        socket_path.copy(address.sun_path, socket_path.size());
+        return address;
+    }
+
+    /// Returns a connected socket or -1
+    int connect_to_server(const std::string& socket_path)
+    {
+        std::optional<sockaddr_un> address = make_socket_address(socket_path);
+        if (!address.has_value()) {
+            return -1;
+        }
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&address.value()), sizeof(sockaddr_un)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    /**
+     * Sends everything written to stdout and stderr while alive into a temporary file, including clang diagnostics.
+    */
+    class ScopedOutputCapture {
+    public:
+        ScopedOutputCapture()
+        {
+            flush_all();
+            m_file = std::tmpfile();
+            if (nullptr != m_file) {
+                m_saved_stdout = ::dup(STDOUT_FILENO);
+                m_saved_stderr = ::dup(STDERR_FILENO);
+                ::dup2(::fileno(m_file), STDOUT_FILENO);
+                ::dup2(::fileno(m_file), STDERR_FILENO);
+            }
+        }
+
+        ~ScopedOutputCapture()
+        {
+            finish();
+        }
+
+        ScopedOutputCapture(const ScopedOutputCapture&) = delete;
+        ScopedOutputCapture& operator=(const ScopedOutputCapture&) = delete;
+
+        /// Restore stdout and stderr and return what was written in between
+        std::string finish()
+        {
+            if (nullptr == m_file) {
+                return {};
+            }
+            flush_all();
+            ::dup2(m_saved_stdout, STDOUT_FILENO);
+            ::dup2(m_saved_stderr, STDERR_FILENO);
+            ::close(m_saved_stdout);
+            ::close(m_saved_stderr);
+
+            std::string output;
+            std::rewind(m_file);
+            char buffer[4096];
+            size_t size = 0;
+            while ((size = std::fread(buffer, 1, sizeof(buffer), m_file)) > 0) {
+                output.append(buffer, size);
+            }
+            std::fclose(m_file);
+            m_file = nullptr;
+            return output;
+        }
+
+    private:
+        static void flush_all()
+        {
+            std::cout.flush();
+            std::cerr.flush();
+            llvm::outs().flush();
+            llvm::errs().flush();
+            std::fflush(stdout);
+            std::fflush(stderr);
+        }
+
+        std::FILE* m_file = nullptr;
+        int m_saved_stdout = -1;
+        int m_saved_stderr = -1;
+    };
+
+    /**
+     * Run the command line of one request in the working directory of its client.
+    */
+    int32_t run_request(const std::string& working_dir, const std::vector<std::string>& args)
+    {
+        std::error_code err;
+        std::filesystem::current_path(working_dir, err);
+        if (err) {
+            std::cerr << std::format("Can't enter working directory {}", working_dir) << std::endl;
+            return 2;
+        }
+
+        int32_t result = 0;
+        try {
+            ControlFlags flags = parse_args(args);
+            GLOBAL_CONTROL_FLAGS = &flags;
+            result = zeno::reflect::run_reflection_generator();
+        } catch (const std::exception& e) {
+            std::cerr << std::format("Generator request failed: {}", e.what()) << std::endl;
+            result = 2;
+        }
+        GLOBAL_CONTROL_FLAGS = nullptr;
+        return result;
+    }
+}
+
+int zeno::reflect::run_generator_server(const ServeFlags& flags)
+{
+    // Clients going away must not take the server with them
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::optional<sockaddr_un> address = make_socket_address(flags.socket);
+    if (!address.has_value()) {
+        std::cerr << std::format("Socket path {} is empty or too long", flags.socket) << std::endl;
+        return 2;
+    }
+
+    if (const int existing = connect_to_server(flags.socket); existing >= 0) {
+        ::close(existing);
+        std::cerr << std::format("A generator is already serving {}", flags.socket) << std::endl;
+        return 1;
+    }
+    // Left behind by a server which didn't shut down cleanly
+    ::unlink(flags.socket.c_str());
+
+    const int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 || ::bind(listen_fd, reinterpret_cast<const sockaddr*>(&address.value()), sizeof(sockaddr_un)) != 0 || ::listen(listen_fd, SOMAXCONN) != 0) {
+        std::cerr << std::format("Can't listen on {}", flags.socket) << std::endl;
+        if (listen_fd >= 0) {
+            ::close(listen_fd);
+        }
+        return 2;
+    }
+
+    const std::string handshake = get_server_handshake();
+    const int timeout_ms = flags.idle_timeout > 0 ? flags.idle_timeout * 1000 : -1;
+    std::cout << std::format("Serving reflection generation requests on {}", flags.socket) << std::endl;
+
+    bool serving = true;
+    while (serving) {
+        pollfd listen_poll { listen_fd, POLLIN, 0 };
+        const int ready = ::poll(&listen_poll, 1, timeout_ms);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready <= 0) {
+            break;
+        }
+
+        const int client_fd = ::accept(listen_fd, nullptr, nullptr);
+        if (client_fd < 0) {
+            continue;
+        }
+        // A client that connects and never sends its request must not block the server
+        set_receive_timeout(client_fd, SERVER_RECEIVE_TIMEOUT_MS);
+
+        // Requests are [handshake, working directory, argv...], anything else is dropped without affecting the server
+        std::optional<std::vector<std::string>> request = receive_strings(client_fd, SERVER_REQUEST_LIMITS);
+        if (!request.has_value() || request->size() < 3 || !is_server_handshake(request->front())) {
+            ::close(client_fd);
+            continue;
+        }
+        if (request->front() != handshake) {
+            // The client runs the request itself, and the next build talks to a server started from the new executable
+            std::cout << "Client was built from a different generator, shutting down" << std::endl;
+            ::close(client_fd);
+            break;
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        const std::vector<std::string> args(request->begin() + 2, request->end());
+        int32_t result = 0;
+        std::string output;
+        {
+            ScopedOutputCapture capture;
+            result = run_request((*request)[1], args);
+            output = capture.finish();
+        }
+        send_strings(client_fd, { std::to_string(result), output });
+        ::close(client_fd);
+
+        const auto end = std::chrono::steady_clock::now();
+        std::cout << std::format("Request from {} finished with {} in {} ms", (*request)[1], result, std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()) << std::endl;
+    }
+
+    ::close(listen_fd);
+    ::unlink(flags.socket.c_str());
+    return 0;
+}
+
+std::optional<int32_t> zeno::reflect::run_on_generator_server(const std::string& socket_path, int argc, char** argv)
+{
+    std::signal(SIGPIPE, SIG_IGN);
+
+    const int fd = connect_to_server(socket_path);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    std::error_code err;
+    std::vector<std::string> request { get_server_handshake(), std::filesystem::current_path(err).string() };
+    request.insert(request.end(), argv, argv + argc);
+
+    std::optional<std::vector<std::string>> response;
+    if (send_strings(fd, request)) {
+        response = receive_strings(fd, SERVER_RESPONSE_LIMITS);
+    }
+    ::close(fd);
+    if (!response.has_value() || response->size() != 2) {
+        return std::nullopt;
+    }
+
+    std::cout << (*response)[1];
+    std::cout.flush();
+    return static_cast<int32_t>(std::stoi((*response)[0]));
+}
+
+#else
+
+int zeno::reflect::run_generator_server(const ServeFlags& flags)
+{
+    std::cerr << "--serve is only supported on platforms with Unix domain sockets" << std::endl;
+    return 2;
+}
+
+std::optional<int32_t> zeno::reflect::run_on_generator_server(const std::string& socket_path, int argc, char** argv)
+{
+    return std::nullopt;
+}
+
+#endif
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "args.hpp"
+
+namespace zeno
+{
+namespace reflect
+{
+    /**
+     * Keep the generator resident and run the generation requests sent to `--socket` one after another.
+     * LLVM is initialized once, and templates and precompiled preambles are reused across requests while their files keep their modification time.
+     * Returns when idle for `--idle_timeout` seconds or when a client built from a different generator executable connects.
+    */
+    int run_generator_server(const ServeFlags& flags);
+
+    /**
+     * Send this command line to the generator serving `socket_path` and forward its output.
+     * Returns the exit code of the request, or nullopt if no compatible server answered and the caller should run it locally.
+    */
+    std::optional<int32_t> run_on_generator_server(const std::string& socket_path, int argc, char** argv);
+}
+}
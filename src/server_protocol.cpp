@@ -0,0 +1,153 @@
+#include <filesystem>
+#include <format>
+#include "server_protocol.hpp"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /**
+     * Identifies the generator executable, a server started before a rebuild must not serve the new generator.
+    */
+    std::string get_executable_stamp()
+    {
+        std::error_code err;
+        const std::filesystem::path executable = "/proc/self/exe";
+        const auto size = std::filesystem::file_size(executable, err);
+        const auto write_time = std::filesystem::last_write_time(executable, err);
+        if (err) {
+            return std::format("{} {}", __DATE__, __TIME__);
+        }
+        return std::format("{}:{}", size, write_time.time_since_epoch().count());
+    }
+}
+
+std::string zeno::reflect::get_server_handshake()
+{
+    return std::format("{}:{}", SERVER_PROTOCOL, get_executable_stamp());
+}
+
+bool zeno::reflect::is_server_handshake(std::string_view handshake)
+{
+    // Protocol versions differ between builds, the name before the version doesn't
+    const std::string_view protocol_name = SERVER_PROTOCOL.substr(0, SERVER_PROTOCOL.find('/') + 1);
+    if (!handshake.starts_with(protocol_name)) {
+        return false;
+    }
+    const size_t stamp_begin = handshake.find(':', protocol_name.size());
+    return stamp_begin != std::string_view::npos && stamp_begin > protocol_name.size() && stamp_begin + 1 < handshake.size();
+}
+
+#ifndef _WIN32
+
+bool zeno::reflect::write_all(int fd, const void* data, size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t written = ::write(fd, bytes, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool zeno::reflect::read_all(int fd, void* data, size_t size)
+{
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        const ssize_t received = ::read(fd, bytes, size);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return false;
+        }
+        bytes += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+bool zeno::reflect::send_strings(int fd, const std::vector<std::string>& strings)
+{
+    const uint64_t count = strings.size();
+    if (!write_all(fd, &count, sizeof(count))) {
+        return false;
+    }
+    for (const std::string& str : strings) {
+        const uint64_t length = str.size();
+        if (!write_all(fd, &length, sizeof(length)) || !write_all(fd, str.data(), str.size())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<std::vector<std::string>> zeno::reflect::receive_strings(int fd, const ServerMessageLimits& limits)
+{
+    uint64_t count = 0;
+    if (!read_all(fd, &count, sizeof(count)) || count > limits.max_strings) {
+        return std::nullopt;
+    }
+    std::vector<std::string> strings;
+    strings.reserve(static_cast<size_t>(count));
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t length = 0;
+        if (!read_all(fd, &length, sizeof(length)) || length > limits.max_string_length) {
+            return std::nullopt;
+        }
+        std::string& str = strings.emplace_back(static_cast<size_t>(length), '\0');
+        if (!read_all(fd, str.data(), str.size())) {
+            return std::nullopt;
+        }
+    }
+    return strings;
+}
+
+bool zeno::reflect::set_receive_timeout(int fd, int timeout_ms)
+{
+    timeval timeout {};
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    return ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0;
+}
+
+#else
+
+bool zeno::reflect::write_all(int fd, const void* data, size_t size)
+{
+    return false;
+}
+
+bool zeno::reflect::read_all(int fd, void* data, size_t size)
+{
+    return false;
+}
+
+bool zeno::reflect::send_strings(int fd, const std::vector<std::string>& strings)
+{
+    return false;
+}
+
+std::optional<std::vector<std::string>> zeno::reflect::receive_strings(int fd, const ServerMessageLimits& limits)
+{
+    return std::nullopt;
+}
+
+bool zeno::reflect::set_receive_timeout(int fd, int timeout_ms)
+{
+    return false;
+}
+
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace zeno
+{
+namespace reflect
+{
+    /// First string of every request, a server only answers clients speaking the same protocol from the same executable
+    constexpr std::string_view SERVER_PROTOCOL = "zeno-reflect-generator/1";
+
+    /// Upper bounds of one message, anything larger is treated as a broken or foreign client
+    struct ServerMessageLimits {
+        uint64_t max_strings;
+        uint64_t max_string_length;
+    };
+
+    /// A request is the handshake, the working directory and the command line
+    constexpr ServerMessageLimits SERVER_REQUEST_LIMITS { 4096, 4 * 1024 * 1024 };
+    /// A response is the exit code and everything the request printed
+    constexpr ServerMessageLimits SERVER_RESPONSE_LIMITS { 2, 256 * 1024 * 1024 };
+
+    /// How long the server waits for a connected client to send its request
+    constexpr int SERVER_RECEIVE_TIMEOUT_MS = 10000;
+
+    /// `SERVER_PROTOCOL` and a stamp of the generator executable
+    std::string get_server_handshake();
+
+    /**
+     * True if `handshake` is a well-formed handshake of any generator build, whether or not it matches this one.
+    */
+    bool is_server_handshake(std::string_view handshake);
+
+    bool write_all(int fd, const void* data, size_t size);
+    bool read_all(int fd, void* data, size_t size);
+
+    /**
+     * Messages are a string count followed by length prefixed strings, both ends run on the same machine so sizes are sent as is.
+    */
+    bool send_strings(int fd, const std::vector<std::string>& strings);
+
+    /**
+     * Read one message. Returns nullopt if the connection fails or times out, or if the message exceeds `limits`,
+     * in which case nothing larger than the limits is allocated.
+    */
+    std::optional<std::vector<std::string>> receive_strings(int fd, const ServerMessageLimits& limits);
+
+    /// Make reads on `fd` fail after `timeout_ms` without data
+    bool set_receive_timeout(int fd, int timeout_ms);
+}
+}
@@ -6,6 +6,10 @@ const char* text::RTTI =
     #include "RTTI.inja"
 ;
 
+const char* text::TYPE_NAME =
+    #include "type_name.inja"
+;
+
 const char* text::GENERATED_TEMPLATE_HEADER_TEMPLATE =
     #include "generated_template_header.inja"
 ;
@@ -0,0 +1,70 @@
+#include "template_library.hpp"
+#include "utils.hpp"
+#include "template/template_literal"
+
+namespace
+{
+    inja::Environment& get_thread_environment()
+    {
+        // The built-in templates and the split register template don't include others, the default environment renders them all
+        thread_local inja::Environment environment;
+        return environment;
+    }
+}
+
+zeno::reflect::TemplateLibrary& zeno::reflect::TemplateLibrary::get()
+{
+    static TemplateLibrary library;
+    return library;
+}
+
+zeno::reflect::TemplateLibrary::TemplateLibrary()
+    : m_rtti(inja::Environment().parse(text::RTTI))
+    , m_type_name(inja::Environment().parse(text::TYPE_NAME))
+    , m_generated_template_header(inja::Environment().parse(text::GENERATED_TEMPLATE_HEADER_TEMPLATE))
+    , m_reflected_metadata(inja::Environment().parse(text::REFLECTED_METADATA))
+{
+}
+
+std::string zeno::reflect::TemplateLibrary::render(const inja::Template& tmpl, const inja::json& data)
+{
+    return get_thread_environment().render(tmpl, data);
+}
+
+void zeno::reflect::TemplateLibrary::render_to(std::ostream& out, const inja::Template& tmpl, const inja::json& data)
+{
+    get_thread_environment().render_to(out, tmpl, data);
+}
+
+void zeno::reflect::TemplateLibrary::render_to(std::ostream& out, const FileTemplate& file_template, const inja::json& data)
+{
+    file_template.environment->render_to(out, *file_template.tmpl, data);
+}
+
+const zeno::reflect::TemplateLibrary::FileTemplate* zeno::reflect::TemplateLibrary::get_file_template(const std::string& path)
+{
+    std::lock_guard lock(m_file_templates_mutex);
+    std::error_code err;
+    const std::filesystem::file_time_type write_time = std::filesystem::last_write_time(path, err);
+    auto it = m_file_templates.find(path);
+    if (it != m_file_templates.end() && !err && it->second->write_time == write_time) {
+        return it->second.get();
+    }
+
+    std::optional<std::string> text = read_file(path);
+    if (!text.has_value()) {
+        return nullptr;
+    }
+    auto file_template = std::make_unique<FileTemplate>();
+    file_template->write_time = write_time;
+    file_template->environment = std::make_unique<inja::Environment>();
+    file_template->tmpl = std::make_unique<inja::Template>(file_template->environment->parse(text.value()));
+    const FileTemplate* result = file_template.get();
+    if (it != m_file_templates.end()) {
+        m_outdated_file_templates.push_back(std::move(it->second));
+        it->second = std::move(file_template);
+    } else {
+        m_file_templates.emplace(path, std::move(file_template));
+    }
+    return result;
+}
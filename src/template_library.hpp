@@ -0,0 +1,66 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "inja/inja.hpp"
+
+namespace zeno
+{
+namespace reflect
+{
+    /**
+     * Templates parsed once, only rendering is done per type.
+     * inja::Environment::render_to reads the environment's template and function storage, so every thread renders
+     * with an environment of its own instead of sharing one with threads that parse.
+    */
+    class TemplateLibrary {
+    public:
+        /**
+         * Template loaded from a file, with the environment holding the templates it includes.
+        */
+        struct FileTemplate {
+            std::filesystem::file_time_type write_time;
+            std::unique_ptr<inja::Environment> environment;
+            std::unique_ptr<inja::Template> tmpl;
+        };
+
+        static TemplateLibrary& get();
+
+        /// Render with the calling thread's environment, `tmpl` must not include other templates
+        std::string render(const inja::Template& tmpl, const inja::json& data);
+        void render_to(std::ostream& out, const inja::Template& tmpl, const inja::json& data);
+
+        /// Render a file template with its own environment, which resolves its includes
+        void render_to(std::ostream& out, const FileTemplate& file_template, const inja::json& data);
+
+        /**
+         * Template loaded from `path` (e.g. the register template in --inja_dir), parsed on first use
+         * and parsed again once the file's modification time changes.
+         * Returns nullptr if the file can't be read.
+        */
+        const FileTemplate* get_file_template(const std::string& path);
+
+        const inja::Template& rtti() const { return m_rtti; }
+        const inja::Template& type_name() const { return m_type_name; }
+        const inja::Template& generated_template_header() const { return m_generated_template_header; }
+        const inja::Template& reflected_metadata() const { return m_reflected_metadata; }
+
+    private:
+        TemplateLibrary();
+
+        inja::Template m_rtti;
+        inja::Template m_type_name;
+        inja::Template m_generated_template_header;
+        inja::Template m_reflected_metadata;
+
+        std::mutex m_file_templates_mutex;
+        std::unordered_map<std::string, std::unique_ptr<FileTemplate>> m_file_templates;
+        /// Replaced templates stay alive, callers may still hold pointers to them
+        std::vector<std::unique_ptr<FileTemplate>> m_outdated_file_templates;
+    };
+}
+}
@@ -2,8 +2,15 @@
 #include <cctype>
 #include <filesystem>
 #include <cassert>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <random>
+#include <fstream>
 #include "utils.hpp"
 #include "args.hpp"
+#include "profiler.hpp"
+#include "template_library.hpp"
 #include "template/template_literal"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Expr.h"
@@ -140,46 +147,225 @@ std::string relative_path_to_header_output(std::string_view abs_path)
     const std::filesystem::path header_output_dir(GLOBAL_CONTROL_FLAGS->output_dir);
     const std::filesystem::path input_path(abs_path);
 
-    return std::filesystem::relative(input_path, header_output_dir).string();
+    return std::filesystem::relative(input_path, header_output_dir).generic_string();
 }
 
-void truncate_file(const std::string &path)
+std::string relative_path_to_include_dirs(std::string_view path, const std::vector<std::string>& include_dirs)
 {
-    std::ofstream s(path, std::ios::out | std::ios::trunc);
-    s.close();
+    const std::string header_path = normalize_path(path);
+    std::string spelling;
+    for (const std::string& include_dir : include_dirs) {
+        if (include_dir.empty()) {
+            continue;
+        }
+        std::filesystem::path dir_path(normalize_path(include_dir));
+        if (!dir_path.has_filename()) {
+            dir_path = dir_path.parent_path();
+        }
+        const std::filesystem::path relative = std::filesystem::path(header_path).lexically_relative(dir_path);
+        if (relative.empty() || *relative.begin() == "..") {
+            continue;
+        }
+        std::string candidate = relative.generic_string();
+        if (!spelling.empty() && candidate.size() >= spelling.size()) {
+            continue;
+        }
+        // The first include dir having the path wins, which has to be this header and not one shadowing it
+        for (const std::string& search_dir : include_dirs) {
+            if (search_dir.empty()) {
+                continue;
+            }
+            std::error_code err;
+            const std::filesystem::path found = std::filesystem::path(search_dir) / candidate;
+            if (std::filesystem::is_regular_file(found, err)) {
+                if (normalize_path(found.string()) == header_path) {
+                    spelling = std::move(candidate);
+                }
+                break;
+            }
+        }
+    }
+    return spelling.empty() ? header_path : spelling;
 }
 
-bool mkdirs(std::string_view path)
+namespace
 {
-    std::filesystem::path dir_path(path);
-    try {
-        if (std::filesystem::create_directories(dir_path)) {
-            return true;
+    std::atomic_uint32_t output_written_count = 0;
+    std::atomic_uint32_t output_unchanged_count = 0;
+    std::atomic_uint32_t output_failed_count = 0;
+
+    constexpr size_t STREAMING_WRITER_BUFFER_SIZE = 1 << 20;
+
+    bool files_have_same_content(const std::string& lhs, const std::string& rhs)
+    {
+        std::error_code err;
+        const uintmax_t lhs_size = std::filesystem::file_size(lhs, err);
+        if (err) {
+            return false;
         }
-    } catch (const std::filesystem::filesystem_error& err) {
-        std::cout << "error: " << err.what() << "\n";
+        const uintmax_t rhs_size = std::filesystem::file_size(rhs, err);
+        if (err || lhs_size != rhs_size) {
+            return false;
+        }
+        std::ifstream lhs_file(lhs, std::ios::in | std::ios::binary);
+        std::ifstream rhs_file(rhs, std::ios::in | std::ios::binary);
+        if (!lhs_file.is_open() || !rhs_file.is_open()) {
+            return false;
+        }
+        std::vector<char> lhs_chunk(64 * 1024);
+        std::vector<char> rhs_chunk(lhs_chunk.size());
+        while (lhs_file && rhs_file) {
+            lhs_file.read(lhs_chunk.data(), static_cast<std::streamsize>(lhs_chunk.size()));
+            rhs_file.read(rhs_chunk.data(), static_cast<std::streamsize>(rhs_chunk.size()));
+            if (lhs_file.gcount() != rhs_file.gcount() || !std::equal(lhs_chunk.begin(), lhs_chunk.begin() + lhs_file.gcount(), rhs_chunk.begin())) {
+                return false;
+            }
+        }
+        return lhs_file.eof() && rhs_file.eof();
     }
 
-    return false;
+    bool file_has_content(const std::string& path, std::string_view content)
+    {
+        std::error_code err;
+        const uintmax_t size = std::filesystem::file_size(path, err);
+        if (err || size != content.size()) {
+            return false;
+        }
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        std::string existing(content.size(), '\0');
+        file.read(existing.data(), static_cast<std::streamsize>(existing.size()));
+        return file.gcount() == static_cast<std::streamsize>(existing.size()) && existing == content;
+    }
+}
+
+bool write_file_atomically(const std::string &path, std::string_view content)
+{
+    const std::string temp_path = make_temp_path(path);
+    {
+        std::ofstream stream(temp_path, std::ios::out | std::ios::trunc | std::ios::binary);
+        stream.write(content.data(), static_cast<std::streamsize>(content.size()));
+        if (!stream.good()) {
+            std::error_code err;
+            std::filesystem::remove(temp_path, err);
+            return false;
+        }
+    }
+    std::error_code err;
+    std::filesystem::rename(temp_path, path, err);
+    if (err) {
+        std::filesystem::remove(temp_path, err);
+        return false;
+    }
+    return true;
 }
 
-std::vector<std::string> find_files_with_extension(std::string_view root, std::string_view extension)
+FileWriteResult write_file_if_changed(const std::string &path, std::string_view content)
 {
-    std::vector<std::string> matching_files;
+    ProfileScope write_scope("write", path);
+    if (file_has_content(path, content)) {
+        ++output_unchanged_count;
+        return FileWriteResult::Unchanged;
+    }
+    if (!write_file_atomically(path, content)) {
+        ++output_failed_count;
+        return FileWriteResult::Failed;
+    }
+    ++output_written_count;
+    return FileWriteResult::Written;
+}
+
+StreamingFileWriter::StreamingFileWriter(std::string path)
+    : m_path(std::move(path))
+    , m_temp_path(make_temp_path(m_path))
+    , m_buffer(STREAMING_WRITER_BUFFER_SIZE)
+{
+    // The buffer must be installed before the file is opened
+    m_stream.rdbuf()->pubsetbuf(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_stream.open(m_temp_path, std::ios::out | std::ios::trunc | std::ios::binary);
+}
 
+StreamingFileWriter::~StreamingFileWriter()
+{
+    if (!m_committed) {
+        m_stream.close();
+        std::error_code err;
+        std::filesystem::remove(m_temp_path, err);
+    }
+}
+
+FileWriteResult StreamingFileWriter::commit()
+{
+    ProfileScope write_scope("write", m_path);
+    m_committed = true;
+    m_stream.close();
+
+    std::error_code err;
+    if (m_stream.fail()) {
+        std::filesystem::remove(m_temp_path, err);
+        ++output_failed_count;
+        return FileWriteResult::Failed;
+    }
+    if (files_have_same_content(m_temp_path, m_path)) {
+        std::filesystem::remove(m_temp_path, err);
+        ++output_unchanged_count;
+        return FileWriteResult::Unchanged;
+    }
+    std::filesystem::rename(m_temp_path, m_path, err);
+    if (err) {
+        std::filesystem::remove(m_temp_path, err);
+        ++output_failed_count;
+        return FileWriteResult::Failed;
+    }
+    ++output_written_count;
+    return FileWriteResult::Written;
+}
+
+OutputWriteSummary get_output_write_summary()
+{
+    return OutputWriteSummary {
+        .written = output_written_count.load(),
+        .unchanged = output_unchanged_count.load(),
+        .failed = output_failed_count.load(),
+    };
+}
+
+void reset_output_write_summary()
+{
+    output_written_count = 0;
+    output_unchanged_count = 0;
+    output_failed_count = 0;
+}
+
+std::string get_cache_dir()
+{
+    if (!GLOBAL_CONTROL_FLAGS->cache_dir.empty()) {
+        return GLOBAL_CONTROL_FLAGS->cache_dir;
+    }
+    return get_file_path_in_header_output(".cache");
+}
+
+std::string make_temp_path(std::string_view path)
+{
+    static std::atomic_uint32_t counter = 0;
+    static const uint32_t seed = std::random_device{}();
+    return std::format("{}.{:08x}{:04x}.tmp", path, seed, counter++);
+}
+
+bool mkdirs(std::string_view path)
+{
+    std::filesystem::path dir_path(path);
     try {
-        if (std::filesystem::exists(root) && std::filesystem::is_directory(root)) {
-            for (const auto& entry : std::filesystem::recursive_directory_iterator(root)) {
-                if (entry.is_regular_file() && entry.path().extension() == extension) {
-                    matching_files.push_back(entry.path().string());
-                }
-            }
+        if (std::filesystem::create_directories(dir_path)) {
+            return true;
         }
     } catch (const std::filesystem::filesystem_error& err) {
         std::cout << "error: " << err.what() << "\n";
     }
 
-    return matching_files;
+    return false;
 }
 
 std::string normalize_filename(std::string_view input)
@@ -187,6 +373,16 @@ std::string normalize_filename(std::string_view input)
     return std::filesystem::path(input).lexically_normal().filename().string();
 }
 
+std::string normalize_path(std::string_view path)
+{
+    std::error_code err;
+    std::filesystem::path absolute_path = std::filesystem::absolute(std::filesystem::path(path), err);
+    if (err) {
+        absolute_path = std::filesystem::path(path);
+    }
+    return absolute_path.lexically_normal().generic_string();
+}
+
 std::string convert_to_valid_cpp_var_name(std::string_view type_name)
 {
     std::string var_name;
@@ -266,31 +462,31 @@ std::string clang_type_name_no_tag(const clang::QualType& type)
     return type.getAsString(policy);
 }
 
-inja::json parse_param_data(const clang::ParmVarDecl * param_decl)
+ReflectedParam parse_param_data(const clang::ParmVarDecl * param_decl)
 {
 
-    inja::json param_data;
+    ReflectedParam param_data;
     clang::QualType type = param_decl->getType();
-    param_data["name"] = param_decl->getName();
-    param_data["type"] = type.getCanonicalType().getAsString();
-    param_data["has_default_arg"] = param_decl->hasDefaultArg();
+    param_data.name = param_decl->getName().str();
+    param_data.type = type.getCanonicalType().getAsString();
+    param_data.has_default_arg = param_decl->hasDefaultArg();
     if (param_decl->hasDefaultArg()) {
-        param_data["default_arg"] = zeno::reflect::clang_expr_to_string(param_decl->getDefaultArg());
+        param_data.default_arg = zeno::reflect::clang_expr_to_string(param_decl->getDefaultArg());
     }
 
     return param_data;
 
 }
 
-inja::json parse_param_data(const clang::FieldDecl *param_decl)
+ReflectedParam parse_param_data(const clang::FieldDecl *param_decl)
 {
-    inja::json param_data;
+    ReflectedParam param_data;
     clang::QualType type = param_decl->getType();
-    param_data["name"] = param_decl->getName();
-    param_data["type"] = type.getCanonicalType().getAsString();
-    param_data["has_default_arg"] = param_decl->hasInClassInitializer();
+    param_data.name = param_decl->getName().str();
+    param_data.type = type.getCanonicalType().getAsString();
+    param_data.has_default_arg = param_decl->hasInClassInitializer();
     if (param_decl->hasInClassInitializer()) {
-        param_data["default_arg"] = zeno::reflect::clang_expr_to_string(param_decl->getInClassInitializer());
+        param_data.default_arg = zeno::reflect::clang_expr_to_string(param_decl->getInClassInitializer());
     }
 
     return param_data;
@@ -373,7 +569,7 @@ bool parse_metadata(std::string &out, const clang::Decl *decl)
 {
     inja::json data;
     if (parse_metadata(data, decl)) {
-        out = inja::render(zeno::reflect::text::REFLECTED_METADATA, data);
+        out = TemplateLibrary::get().render(TemplateLibrary::get().reflected_metadata(), data);
         return true;
     }
 
@@ -394,6 +590,39 @@ const clang::Type *get_underlying_type(const clang::Type *type)
     return type;
 }
 
+uint32_t resolve_job_count(int requested_jobs)
+{
+    if (requested_jobs > 0) {
+        return static_cast<uint32_t>(requested_jobs);
+    }
+    return std::max(1U, std::thread::hardware_concurrency());
+}
+
+void parallel_for(size_t count, uint32_t jobs, const std::function<void(size_t index, uint32_t worker_id)>& task)
+{
+    if (jobs <= 1 || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i, 0);
+        }
+        return;
+    }
+
+    std::atomic_size_t next_index = 0;
+    const uint32_t worker_count = static_cast<uint32_t>(std::min<size_t>(jobs, count));
+    std::vector<std::thread> workers;
+    workers.reserve(worker_count);
+    for (uint32_t worker_id = 0; worker_id < worker_count; ++worker_id) {
+        workers.emplace_back([&next_index, &task, count, worker_id]() {
+            for (size_t i = next_index++; i < count; i = next_index++) {
+                task(i, worker_id);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
 constexpr uint32_t FNV1aHash::hash_32_fnv1a(std::string_view str) const noexcept
 {
     uint32_t hash = internal::FNV1aInternal<uint32_t>::val;
@@ -9,7 +9,9 @@
 #include <vector>
 #include <format>
 #include <string_view>
+#include <functional>
 #include "metadata.hpp"
+#include "model.hpp"
 #include "inja/inja.hpp"
 
 namespace clang {
@@ -45,17 +47,84 @@ void replace_all(std::string& out_str, const std::string& from, const std::strin
 
 std::string get_file_path_in_header_output(std::string_view filename);
 std::string relative_path_to_header_output(std::string_view abs_path);
-void truncate_file(const std::string& path);
+/**
+ * Spelling of `path` in an #include resolved through `include_dirs`, the shortest one the compiler resolves to this same file.
+ * Generated sources don't embed where the tree is checked out this way, falls back to the normalized path if no include dir contains it.
+*/
+std::string relative_path_to_include_dirs(std::string_view path, const std::vector<std::string>& include_dirs);
+/**
+ * Directory where the generator keeps data reused across runs, `--cache_dir` or `<header_output>/.cache`.
+*/
+std::string get_cache_dir();
+/**
+ * A unique sibling path of `path`, used to write files aside before renaming them in place.
+*/
+std::string make_temp_path(std::string_view path);
+/**
+ * Write `content` to a temporary sibling of `path` and rename it in place, readers never see a partial file.
+*/
+bool write_file_atomically(const std::string& path, std::string_view content);
+
+enum class FileWriteResult {
+    Unchanged,
+    Written,
+    Failed,
+};
+
+/**
+ * Replace `path` atomically with `content` unless it already holds exactly these bytes.
+ * Keeping the mtime of unchanged outputs avoids recompiling everything including them.
+*/
+FileWriteResult write_file_if_changed(const std::string& path, std::string_view content);
+
+struct OutputWriteSummary {
+    uint32_t written = 0;
+    uint32_t unchanged = 0;
+    uint32_t failed = 0;
+};
+
+/// Tally of every write_file_if_changed call and committed StreamingFileWriter so far
+OutputWriteSummary get_output_write_summary();
+
+/// Start a new tally, each request of a resident generator reports only its own outputs
+void reset_output_write_summary();
+
+/**
+ * Buffered writer for large outputs, content goes to a temporary sibling of `path` as it is produced.
+ * commit() replaces `path` only if the content differs, like write_file_if_changed. Uncommitted writers discard their file.
+*/
+class StreamingFileWriter {
+public:
+    explicit StreamingFileWriter(std::string path);
+    ~StreamingFileWriter();
+
+    StreamingFileWriter(const StreamingFileWriter&) = delete;
+    StreamingFileWriter& operator=(const StreamingFileWriter&) = delete;
+
+    std::ostream& stream() { return m_stream; }
+
+    FileWriteResult commit();
+
+private:
+    std::string m_path;
+    std::string m_temp_path;
+    std::vector<char> m_buffer;
+    std::ofstream m_stream;
+    bool m_committed = false;
+};
 bool mkdirs(std::string_view path);
-std::vector<std::string> find_files_with_extension(std::string_view root, std::string_view extension);
 
 std::string normalize_filename(std::string_view input);
+/**
+ * Absolute, lexically normalized form of `path` with forward slashes, used to compare paths reported by clang.
+*/
+std::string normalize_path(std::string_view path);
 std::string convert_to_valid_cpp_var_name(std::string_view type_name);
 
 std::string clang_expr_to_string(const clang::Expr* expr);
 std::string clang_type_name_no_tag(const clang::QualType& type);
-inja::json parse_param_data(const clang::ParmVarDecl* param_decl);
-inja::json parse_param_data(const clang::FieldDecl* param_decl);
+ReflectedParam parse_param_data(const clang::ParmVarDecl* param_decl);
+ReflectedParam parse_param_data(const clang::FieldDecl* param_decl);
 
 inja::json parse_metadata(const MetadataContainer& metadata);
 bool parse_metadata(inja::json& out, const clang::Decl* decl);
@@ -63,6 +132,19 @@ bool parse_metadata(std::string& out, const clang::Decl* decl);
 
 const clang::Type* get_underlying_type(const clang::Type* type);
 
+/**
+ * Resolve the value of `--jobs` to the number of worker threads to spawn.
+ * Zero or negative values fall back to the hardware concurrency.
+*/
+uint32_t resolve_job_count(int requested_jobs);
+
+/**
+ * Invoke `task(index, worker_id)` for every index in [0, count) using up to `jobs` threads.
+ * Indices are handed out in increasing order, `worker_id` is stable for the lifetime of a thread
+ * and can be used to address per-worker state.
+*/
+void parallel_for(size_t count, uint32_t jobs, const std::function<void(size_t index, uint32_t worker_id)>& task);
+
 namespace internal {
     template <typename T>
     struct FNV1aInternal {
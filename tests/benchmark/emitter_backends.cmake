@@ -0,0 +1,35 @@
+# Generate RECORD_COUNT synthetic records with each --emitter backend and print the wall time, the render phase and the peak
+# resident memory of both. Fails if their outputs aren't byte identical.
+#
+# cmake <arguments of generator/common.cmake> -DRECORD_COUNT=<n> -P emitter_backends.cmake
+
+include("${CMAKE_CURRENT_LIST_DIR}/../generator/common.cmake")
+include("${CMAKE_CURRENT_LIST_DIR}/synthetic_records.cmake")
+
+if (NOT RECORD_COUNT)
+    message(FATAL_ERROR "RECORD_COUNT is required")
+endif()
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+write_synthetic_headers("${WORK_DIR}/headers" ${RECORD_COUNT} HEADERS)
+list(PREPEND INCLUDE_DIRS "${WORK_DIR}/headers")
+
+set(report "")
+foreach(backend inja native)
+    run_generator("${WORK_DIR}/${backend}" "${INJA_DIR}" --emitter=${backend} --jobs=0 --time_report)
+
+    # See print_time_report in src/profiler.cpp
+    set(render_ms "?")
+    if (generator_output MATCHES "\n  render +([0-9.]+)")
+        set(render_ms "${CMAKE_MATCH_1}")
+    endif()
+    set(peak_rss "?")
+    if (generator_output MATCHES "peak resident memory ([0-9.]+) MiB")
+        set(peak_rss "${CMAKE_MATCH_1}")
+    endif()
+    string(APPEND report "  ${backend}: ${generator_milliseconds} ms wall, ${render_ms} ms render, ${peak_rss} MiB peak resident memory\n")
+endforeach()
+
+message(STATUS "Emitter backends over ${RECORD_COUNT} records\n${report}")
+
+require_identical_outputs("${WORK_DIR}/inja" "${WORK_DIR}/native" "--emitter=inja" "--emitter=native")
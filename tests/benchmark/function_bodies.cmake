@@ -0,0 +1,43 @@
+# Generate the same headers with and without --parse_function_bodies and print the time spent in the header phase,
+# which parses and matches the reflected declarations, for both. Fails if the outputs aren't byte identical.
+#
+# cmake <arguments of generator/common.cmake> [-DRECORD_COUNT=<n>] [-DINPUT_HEADERS=<h1|h2|...>] [-DEXTRA_INCLUDE_DIRS=<d1|d2|...>]
+#       -P function_bodies.cmake
+#
+# RECORD_COUNT generates synthetic records, INPUT_HEADERS replaces HEADERS (e.g. with the headers of the example target).
+
+include("${CMAKE_CURRENT_LIST_DIR}/../generator/common.cmake")
+include("${CMAKE_CURRENT_LIST_DIR}/synthetic_records.cmake")
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+if (RECORD_COUNT)
+    write_synthetic_headers("${WORK_DIR}/headers" ${RECORD_COUNT} HEADERS)
+    list(PREPEND INCLUDE_DIRS "${WORK_DIR}/headers")
+elseif (INPUT_HEADERS)
+    string(REPLACE "|" ";" HEADERS "${INPUT_HEADERS}")
+endif()
+if (EXTRA_INCLUDE_DIRS)
+    string(REPLACE "|" ";" EXTRA_INCLUDE_DIRS "${EXTRA_INCLUDE_DIRS}")
+    list(PREPEND INCLUDE_DIRS ${EXTRA_INCLUDE_DIRS})
+endif()
+list(LENGTH HEADERS header_count)
+
+set(report "")
+foreach(mode parsed skipped)
+    set(args --jobs=1 --time_report)
+    if (mode STREQUAL "parsed")
+        list(APPEND args --parse_function_bodies)
+    endif()
+    run_generator("${WORK_DIR}/${mode}" "${INJA_DIR}" ${args})
+
+    # See print_time_report in src/profiler.cpp
+    set(header_ms "?")
+    if (generator_output MATCHES "\n  header +([0-9.]+)")
+        set(header_ms "${CMAKE_MATCH_1}")
+    endif()
+    string(APPEND report "  function bodies ${mode}: ${header_ms} ms in the header phase, ${generator_milliseconds} ms wall\n")
+endforeach()
+
+message(STATUS "Parse time over ${header_count} headers\n${report}")
+
+require_identical_outputs("${WORK_DIR}/parsed" "${WORK_DIR}/skipped" "--parse_function_bodies" "function bodies skipped")
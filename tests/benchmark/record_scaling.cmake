@@ -0,0 +1,46 @@
+# Generate RECORD_COUNTS synthetic records and print the generator's wall time for each count.
+# Fails when the time per record of the largest count exceeds MAX_PER_RECORD_GROWTH (default 3) times that of the smallest,
+# growth quadratic in the number of records shows up as a factor close to the ratio of the counts.
+#
+# cmake <arguments of generator/common.cmake> -DRECORD_COUNTS=<n1|n2|...> [-DMAX_PER_RECORD_GROWTH=<factor>] -P record_scaling.cmake
+
+include("${CMAKE_CURRENT_LIST_DIR}/../generator/common.cmake")
+include("${CMAKE_CURRENT_LIST_DIR}/synthetic_records.cmake")
+
+string(REPLACE "|" ";" RECORD_COUNTS "${RECORD_COUNTS}")
+if (NOT RECORD_COUNTS)
+    message(FATAL_ERROR "RECORD_COUNTS is required")
+endif()
+if (NOT MAX_PER_RECORD_GROWTH)
+    set(MAX_PER_RECORD_GROWTH 3)
+endif()
+
+set(fixture_include_dirs ${INCLUDE_DIRS})
+set(report "")
+set(first_count "")
+foreach(count IN LISTS RECORD_COUNTS)
+    set(dir "${WORK_DIR}/records_${count}")
+    file(REMOVE_RECURSE "${dir}")
+    write_synthetic_headers("${dir}/headers" ${count} HEADERS)
+    set(INCLUDE_DIRS "${dir}/headers" ${fixture_include_dirs})
+    run_generator("${dir}/out" "${INJA_DIR}" --jobs=0 --precompiled_preamble)
+
+    math(EXPR per_record_us "${generator_milliseconds} * 1000 / ${count}")
+    string(APPEND report "  ${count} records: ${generator_milliseconds} ms, ${per_record_us} us per record\n")
+    if (NOT first_count)
+        set(first_count ${count})
+        set(first_per_record_us ${per_record_us})
+    endif()
+    set(last_count ${count})
+    set(last_per_record_us ${per_record_us})
+endforeach()
+
+message(STATUS "Generator wall time by record count\n${report}")
+# Whole microseconds per record, the smallest count is never below 1
+if (first_per_record_us LESS 1)
+    set(first_per_record_us 1)
+endif()
+math(EXPR allowed_us "${first_per_record_us} * ${MAX_PER_RECORD_GROWTH}")
+if (last_per_record_us GREATER allowed_us)
+    message(FATAL_ERROR "Time per record grew from ${first_per_record_us} us at ${first_count} records to ${last_per_record_us} us at ${last_count} records")
+endif()
@@ -0,0 +1,64 @@
+# Compile the register sources the build generated for TARGET on their own and print the compile time and the text size
+# of each object. Run it after building the target, the sources are read from the build tree.
+#
+# cmake -DTARGET=<name> -DSOURCE_DIR=<intermediate dir of the target> -DWORK_DIR=<dir> -DCXX_COMPILER=<path>
+#       -DCXX_STANDARD=<n> -DINCLUDE_DIRS=<d1|d2|...> -DSIZE_TOOL=<path> -P register_sources.cmake
+
+foreach(variable TARGET SOURCE_DIR WORK_DIR CXX_COMPILER INCLUDE_DIRS SIZE_TOOL)
+    if (NOT DEFINED ${variable})
+        message(FATAL_ERROR "${variable} is required")
+    endif()
+endforeach()
+if (NOT CXX_STANDARD)
+    set(CXX_STANDARD 17)
+endif()
+
+string(REPLACE "|" ";" INCLUDE_DIRS "${INCLUDE_DIRS}")
+set(include_args "")
+foreach(dir IN LISTS INCLUDE_DIRS)
+    list(APPEND include_args "-I${dir}")
+endforeach()
+
+# <target>.generated.cpp, or <target>.generated.<shard>.cpp with --shards, see zeno_get_reflection_register_sources
+file(GLOB sources "${SOURCE_DIR}/${TARGET}.generated*.cpp")
+list(SORT sources)
+if (NOT sources)
+    message(FATAL_ERROR "No register source of ${TARGET} in ${SOURCE_DIR}, build the target first")
+endif()
+
+file(MAKE_DIRECTORY "${WORK_DIR}")
+set(report "")
+set(total_ms 0)
+set(total_text 0)
+foreach(source IN LISTS sources)
+    get_filename_component(name "${source}" NAME_WE)
+    get_filename_component(extension "${source}" EXT)
+    set(object "${WORK_DIR}/${name}${extension}.o")
+    string(TIMESTAMP begin "%s%f" UTC)
+    execute_process(
+        COMMAND "${CXX_COMPILER}" -std=c++${CXX_STANDARD} -O2 ${include_args} -c "${source}" -o "${object}"
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE output
+    )
+    string(TIMESTAMP end "%s%f" UTC)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "Failed to compile ${source}:\n${output}")
+    endif()
+    math(EXPR milliseconds "(${end} - ${begin}) / 1000")
+
+    # Berkeley format: a header line, then "text data bss dec hex filename", text counts code and read-only data
+    execute_process(COMMAND "${SIZE_TOOL}" "${object}" RESULT_VARIABLE result OUTPUT_VARIABLE size_output ERROR_VARIABLE size_output)
+    if (NOT result EQUAL 0 OR NOT size_output MATCHES "\n[ \t]*([0-9]+)")
+        message(FATAL_ERROR "Failed to read the size of ${object}:\n${size_output}")
+    endif()
+    set(text_bytes ${CMAKE_MATCH_1})
+
+    file(SIZE "${source}" source_bytes)
+    get_filename_component(source_name "${source}" NAME)
+    string(APPEND report "  ${source_name}: ${source_bytes} bytes of source, ${milliseconds} ms to compile, ${text_bytes} bytes of text\n")
+    math(EXPR total_ms "${total_ms} + ${milliseconds}")
+    math(EXPR total_text "${total_text} + ${text_bytes}")
+endforeach()
+
+message(STATUS "Register sources of ${TARGET} (-O2)\n${report}  total: ${total_ms} ms to compile, ${total_text} bytes of text")
@@ -0,0 +1,53 @@
+# write_synthetic_headers(<dir> <record_count> <out_var>)
+# Writes <record_count> reflected records into <dir>/bench/records_<N>.h, 100 records per header, and sets <out_var> to the header paths.
+# Every header also includes <dir>/bench/common.h, whose records each input reaches again.
+function(write_synthetic_headers dir record_count out_var)
+    set(common_header "${dir}/bench/common.h")
+    set(common_text "#pragma once\n\n#include <string>\n\nnamespace bench\n{\n")
+    foreach(index RANGE 9)
+        string(APPEND common_text
+            "    struct ZRECORD() Common${index} {\n"
+            "        int id = ${index};\n"
+            "        std::string name;\n"
+            "    };\n")
+    endforeach()
+    string(APPEND common_text "}\n")
+    file(WRITE "${common_header}" "${common_text}")
+
+    set(headers "")
+    math(EXPR header_count "(${record_count} + 99) / 100")
+    math(EXPR last_header "${header_count} - 1")
+    foreach(header_index RANGE ${last_header})
+        set(text "#pragma once\n\n#include <string>\n#include <vector>\n#include \"bench/common.h\"\n\nnamespace bench\n{\n")
+        math(EXPR first_record "${header_index} * 100")
+        math(EXPR last_record "${first_record} + 99")
+        if (last_record GREATER_EQUAL record_count)
+            math(EXPR last_record "${record_count} - 1")
+        endif()
+        foreach(record RANGE ${first_record} ${last_record})
+            math(EXPR common_index "${record} % 10")
+            string(APPEND text
+                "    struct ZRECORD() Record${record} {\n"
+                "        int id = 0;\n"
+                "        float weight = 1.0f;\n"
+                "        std::string name;\n"
+                "        std::vector<int> values;\n"
+                "        Common${common_index} common;\n"
+                "\n"
+                "        Record${record}() = default;\n"
+                "        Record${record}(int id, float weight) : id(id), weight(weight) {}\n"
+                "\n"
+                "        ZMETHOD()\n"
+                "        int scaled(int factor) const { return id * factor; }\n"
+                "\n"
+                "        ZMETHOD()\n"
+                "        void rename(const std::string& value) { name = value; }\n"
+                "    };\n")
+        endforeach()
+        string(APPEND text "}\n")
+        set(header "${dir}/bench/records_${header_index}.h")
+        file(WRITE "${header}" "${text}")
+        list(APPEND headers "${header}")
+    endforeach()
+    set(${out_var} "${headers}" PARENT_SCOPE)
+endfunction()
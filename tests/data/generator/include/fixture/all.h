@@ -0,0 +1,5 @@
+#pragma once
+
+// Declares nothing itself, everything comes from the headers it includes
+#include "fixture/scene.h"
+#include "fixture/names.h"
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+#include "reflect/registry.hpp"
+
+namespace fixture
+{
+    struct ZRECORD() Settings {
+        int level = 1;
+        double scale = 1.0;
+        std::string label;
+    };
+}
+
+REFLECT_REGISTER_RTTI_TYPE_WITH_NAME(double, Double)
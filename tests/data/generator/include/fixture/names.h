@@ -0,0 +1,8 @@
+#pragma once
+
+#include "reflect/registry.hpp"
+#include "fixture/widget.h"
+
+REFLECT_REGISTER_RTTI_TYPE_WITH_NAME(fixture::Widget, Widget)
+REFLECT_REGISTER_RTTI_TYPE_WITH_NAME(fixture::Gadget*, GadgetPtr)
+REFLECT_REGISTER_RTTI_TYPE_WITH_NAME(float, Float)
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <vector>
+#include "fixture/shapes.h"
+
+namespace fixture
+{
+    struct ZRECORD() Scene {
+        std::vector<Shape> shapes;
+        Widget root;
+        Gadget* gadget = nullptr;
+        bool visible = true;
+
+        ZMETHOD()
+        void add(const Shape& shape) {
+            shapes.push_back(shape);
+        }
+    };
+}
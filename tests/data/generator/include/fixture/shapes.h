@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "fixture/widget.h"
+
+namespace fixture
+{
+    struct ZRECORD(DisplayName="Shape") Shape {
+        std::string name;
+        std::vector<float> points;
+        Widget* owner = nullptr;
+
+        ZMETHOD()
+        float area(const Widget& widget, bool closed) const {
+            return closed ? static_cast<float>(widget.id) : 0.0f;
+        }
+
+        // Clang keeps parsing deduced and constexpr bodies when it skips function bodies, the outputs must not change
+        ZMETHOD()
+        auto point_count() const {
+            return points.size();
+        }
+
+        ZMETHOD()
+        static constexpr int dimensions() {
+            return 2;
+        }
+
+        ZMETHOD()
+        void scale(float factor = 2.0f) {
+            for (float& point : points) {
+                point *= factor;
+            }
+        }
+    };
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+namespace fixture
+{
+    struct Widget {
+        int id = 0;
+    };
+
+    struct Gadget {
+        float weight = 0.0f;
+    };
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+#include "annotated.h"
+#include "plain_dep.h"
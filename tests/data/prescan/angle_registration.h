@@ -0,0 +1,4 @@
+#pragma once
+
+#include <vector>
+#include <manual_registration.h>
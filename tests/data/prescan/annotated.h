@@ -0,0 +1,6 @@
+#pragma once
+
+struct ZRECORD() Annotated {
+    ZPROPERTY()
+    int value;
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "reflect/registry.hpp"
+
+struct ManualRegistration {
+    int value;
+};
+
+REFLECT_REGISTER_RTTI_TYPE_MANUAL(ManualRegistration)
@@ -0,0 +1,4 @@
+#pragma once
+
+#define PROJECT_RECORD(...) \
+    ZRECORD(__VA_ARGS__)
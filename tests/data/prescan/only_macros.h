@@ -0,0 +1,7 @@
+#pragma once
+
+#include "macros.h"
+
+struct NoMacroUse {
+    int value;
+};
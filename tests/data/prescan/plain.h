@@ -0,0 +1,10 @@
+#pragma once
+
+#include <vector>
+#include "plain_dep.h"
+#include "missing.h"
+#include "reflect/registry.hpp"
+
+struct Plain {
+    std::vector<PlainDependency> values;
+};
@@ -0,0 +1,5 @@
+#pragma once
+
+struct PlainDependency {
+    int value;
+};
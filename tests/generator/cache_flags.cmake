@@ -0,0 +1,35 @@
+# Require each of FLAG_ARGS to change the flags hash stored in the reflection cache,
+# so results cached by a run without the flag are dropped by a run with it.
+#
+# cmake <arguments of common.cmake> -DFLAG_ARGS=<f1|f2|...> -P cache_flags.cmake
+
+include("${CMAKE_CURRENT_LIST_DIR}/common.cmake")
+
+string(REPLACE "|" ";" FLAG_ARGS "${FLAG_ARGS}")
+if (NOT FLAG_ARGS)
+    message(FATAL_ERROR "FLAG_ARGS is required")
+endif()
+
+# All runs share the output directory, which is part of the flags as well
+set(output_dir "${WORK_DIR}/out")
+
+function(read_flags_hash out_var)
+    file(READ "${output_dir}/include/.cache/fixture.reflection_cache.json" cache)
+    string(JSON flags GET "${cache}" flags)
+    set(${out_var} "${flags}" PARENT_SCOPE)
+endfunction()
+
+file(REMOVE_RECURSE "${output_dir}")
+run_generator("${output_dir}" "${INJA_DIR}" --incremental)
+read_flags_hash(base_flags)
+
+foreach(flag_arg IN LISTS FLAG_ARGS)
+    run_generator("${output_dir}" "${INJA_DIR}" --incremental "${flag_arg}")
+    read_flags_hash(flags)
+    if (flags STREQUAL base_flags)
+        message(FATAL_ERROR "'${flag_arg}' doesn't change the flags hash of the reflection cache")
+    endif()
+endforeach()
+
+list(LENGTH FLAG_ARGS flag_count)
+message(STATUS "${flag_count} flags change the flags hash of the reflection cache")
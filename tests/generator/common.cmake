@@ -0,0 +1,80 @@
+# Arguments every generator test script takes, and run_generator to generate headers with them.
+#
+# -DGENERATOR=<path> -DWORK_DIR=<dir> -DINCLUDE_DIRS=<d1|d2|...> -DPRE_INCLUDE_HEADER=<path> -DINJA_DIR=<dir> [-DHEADERS=<h1|h2|...>]
+#
+# Tests pass the fixture headers as HEADERS, benchmarks set it to the headers they write before calling run_generator.
+
+foreach(variable GENERATOR WORK_DIR INCLUDE_DIRS PRE_INCLUDE_HEADER INJA_DIR)
+    if (NOT DEFINED ${variable})
+        message(FATAL_ERROR "${variable} is required")
+    endif()
+endforeach()
+
+foreach(variable HEADERS INCLUDE_DIRS)
+    string(REPLACE "|" ";" ${variable} "${${variable}}")
+endforeach()
+
+# run_generator(<output_dir> <inja_dir> [<args>...])
+# Generates HEADERS, headers go to <output_dir>/include and the register source to <output_dir>/register.generated.cpp.
+# Sets generator_output to what the generator printed and generator_milliseconds to its wall time.
+function(run_generator output_dir inja_dir)
+    list(JOIN HEADERS "," input_sources)
+    list(JOIN INCLUDE_DIRS "," include_dirs)
+    string(TIMESTAMP begin "%s%f" UTC)
+    execute_process(
+        COMMAND "${GENERATOR}"
+            "--include_dirs=${include_dirs}"
+            "--pre_include_header=${PRE_INCLUDE_HEADER}"
+            "--input_source=${input_sources}"
+            "--header_output=${output_dir}/include"
+            "--inja_dir=${inja_dir}"
+            "--generated_source_path=${output_dir}/register.generated.cpp"
+            "--target_name=fixture"
+            "--stdc++=17"
+            ${ARGN}
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE output
+    )
+    string(TIMESTAMP end "%s%f" UTC)
+    if (NOT result EQUAL 0)
+        list(JOIN ARGN " " args_text)
+        message(FATAL_ERROR "Generator failed with ${result} for '${args_text}':\n${output}")
+    endif()
+    math(EXPR milliseconds "(${end} - ${begin}) / 1000")
+    set(generator_output "${output}" PARENT_SCOPE)
+    set(generator_milliseconds ${milliseconds} PARENT_SCOPE)
+endfunction()
+
+# require_identical_outputs(<dir_a> <dir_b> <description_a> <description_b>)
+# Fails unless both output directories hold the same files with the same content, the cache excluded.
+function(require_identical_outputs dir_a dir_b description_a description_b)
+    file(GLOB_RECURSE files_a RELATIVE "${dir_a}" "${dir_a}/*")
+    file(GLOB_RECURSE files_b RELATIVE "${dir_b}" "${dir_b}/*")
+    list(FILTER files_a EXCLUDE REGEX "(^|/)\\.cache/")
+    list(FILTER files_b EXCLUDE REGEX "(^|/)\\.cache/")
+    list(SORT files_a)
+    list(SORT files_b)
+    if (NOT files_a STREQUAL files_b)
+        message(FATAL_ERROR "Different outputs\n  ${description_a}: ${files_a}\n  ${description_b}: ${files_b}")
+    endif()
+    if (NOT files_a)
+        message(FATAL_ERROR "The generator wrote nothing")
+    endif()
+
+    set(different_files "")
+    foreach(file IN LISTS files_a)
+        file(SHA256 "${dir_a}/${file}" hash_a)
+        file(SHA256 "${dir_b}/${file}" hash_b)
+        if (NOT hash_a STREQUAL hash_b)
+            list(APPEND different_files "${file}")
+        endif()
+    endforeach()
+    if (different_files)
+        list(JOIN different_files "\n  " different_files)
+        message(FATAL_ERROR "Outputs of '${description_a}' and '${description_b}' differ in\n  ${different_files}")
+    endif()
+
+    list(LENGTH files_a file_count)
+    message(STATUS "${file_count} outputs of '${description_a}' and '${description_b}' are identical")
+endfunction()
@@ -0,0 +1,30 @@
+# Run the generator twice over the same headers and require byte identical outputs.
+#
+# cmake -DGENERATOR=<path> -DWORK_DIR=<dir> -DHEADERS=<h1|h2|...> -DINCLUDE_DIRS=<d1|d2|...> -DPRE_INCLUDE_HEADER=<path>
+#       -DINJA_DIR=<dir> [-DINJA_DIR_B=<dir>] -DARGS_A=<a1|a2|...> -DARGS_B=<b1|b2|...> [-DPRIME_ARGS_B=<p1|p2|...>] -P compare_outputs.cmake
+#
+# Lists use '|' since add_test splits arguments on ';'. PRIME_ARGS_B runs the generator once more in the output directory of B
+# before the compared run, e.g. to fill the cache of an incremental run with different flags.
+# INJA_DIR_B replaces INJA_DIR for the runs of B.
+
+include("${CMAKE_CURRENT_LIST_DIR}/common.cmake")
+
+if (NOT INJA_DIR_B)
+    set(INJA_DIR_B "${INJA_DIR}")
+endif()
+
+foreach(variable ARGS_A ARGS_B PRIME_ARGS_B)
+    string(REPLACE "|" ";" ${variable} "${${variable}}")
+endforeach()
+
+list(JOIN ARGS_A " " args_a_text)
+list(JOIN ARGS_B " " args_b_text)
+
+file(REMOVE_RECURSE "${WORK_DIR}/a" "${WORK_DIR}/b")
+run_generator("${WORK_DIR}/a" "${INJA_DIR}" ${ARGS_A})
+if (PRIME_ARGS_B)
+    run_generator("${WORK_DIR}/b" "${INJA_DIR_B}" ${PRIME_ARGS_B})
+endif()
+run_generator("${WORK_DIR}/b" "${INJA_DIR_B}" ${ARGS_B})
+
+require_identical_outputs("${WORK_DIR}/a" "${WORK_DIR}/b" "${args_a_text}" "${args_b_text}")
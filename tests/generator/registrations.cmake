@@ -0,0 +1,36 @@
+# Generate the headers with ARGS and require the register source to register exactly EXPECTED_TYPES, each of them once.
+#
+# cmake <arguments of common.cmake> -DEXPECTED_TYPES=<t1|t2|...> [-DARGS=<a1|a2|...>] -P registrations.cmake
+
+include("${CMAKE_CURRENT_LIST_DIR}/common.cmake")
+
+foreach(variable EXPECTED_TYPES ARGS)
+    string(REPLACE "|" ";" ${variable} "${${variable}}")
+endforeach()
+if (NOT EXPECTED_TYPES)
+    message(FATAL_ERROR "EXPECTED_TYPES is required")
+endif()
+
+file(REMOVE_RECURSE "${WORK_DIR}/out")
+run_generator("${WORK_DIR}/out" "${INJA_DIR}" ${ARGS})
+
+file(READ "${WORK_DIR}/out/register.generated.cpp" register_source)
+string(REGEX MATCHALL "/// ==== Begin [^\n]* Register ====" sections "${register_source}")
+set(registered_types "")
+foreach(section IN LISTS sections)
+    string(REGEX REPLACE "^/// ==== Begin (.*) Register ====$" "\\1" type "${section}")
+    list(APPEND registered_types "${type}")
+endforeach()
+
+set(sorted_registered ${registered_types})
+set(sorted_expected ${EXPECTED_TYPES})
+list(SORT sorted_registered)
+list(SORT sorted_expected)
+if (NOT sorted_registered STREQUAL sorted_expected)
+    list(JOIN registered_types ", " registered_text)
+    list(JOIN EXPECTED_TYPES ", " expected_text)
+    message(FATAL_ERROR "Registered types differ\n  registered: ${registered_text}\n  expected:   ${expected_text}")
+endif()
+
+list(LENGTH registered_types type_count)
+message(STATUS "${type_count} types registered once each")
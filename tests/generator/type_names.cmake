@@ -0,0 +1,36 @@
+# Generate the headers and check the named pointer type registered with REFLECT_REGISTER_RTTI_TYPE_WITH_NAME in fixture/names.h.
+# It gets its gParamType_ constant but no type_info specialization, libreflect derives its RTTI from the pointee.
+#
+# cmake <arguments of common.cmake> -P type_names.cmake
+
+include("${CMAKE_CURRENT_LIST_DIR}/common.cmake")
+
+file(REMOVE_RECURSE "${WORK_DIR}/out")
+run_generator("${WORK_DIR}/out" "${INJA_DIR}" --jobs=1)
+
+file(GLOB_RECURSE generated_headers "${WORK_DIR}/out/include/*")
+list(FILTER generated_headers EXCLUDE REGEX "/\\.cache/")
+set(generated "")
+foreach(header IN LISTS generated_headers)
+    file(READ "${header}" content)
+    string(APPEND generated "${content}")
+endforeach()
+
+# The hash libreflect computes for the name of type_info<fixture::Gadget *>(), see rtti::hash_type_name
+set(gadget_ptr_hash 11206578470101602548)
+
+string(REGEX MATCHALL "constexpr size_t gParamType_GadgetPtr = [0-9]+ULL;" matches "${generated}")
+if (NOT matches STREQUAL "constexpr size_t gParamType_GadgetPtr = ${gadget_ptr_hash}ULL;")
+    message(FATAL_ERROR "Expected 'constexpr size_t gParamType_GadgetPtr = ${gadget_ptr_hash}ULL;' once in the generated headers, found '${matches}'")
+endif()
+
+foreach(unexpected "type_info<fixture::Gadget \\*>\\(\\)" "gParamType_Gadget = ")
+    if (generated MATCHES "${unexpected}")
+        message(FATAL_ERROR "The generated headers contain '${unexpected}'")
+    endif()
+endforeach()
+if (NOT generated MATCHES "type_info<fixture::Gadget>\\(\\)")
+    message(FATAL_ERROR "The generated headers have no RTTI of fixture::Gadget")
+endif()
+
+message(STATUS "GadgetPtr is a name constant of the RTTI libreflect derives")
@@ -0,0 +1,303 @@
+#include <cstring>
+#include <string>
+#include "reflect/core.hpp"
+#include "reflect/typeinfo.hpp"
+#include "reflect/type.hpp"
+#include "reflect/registry.hpp"
+#include "reflect/metadata.hpp"
+#include "reflect/descriptor.hpp"
+#include "test_common.hpp"
+
+namespace fixture {
+    struct Base {
+        int base_id = 7;
+    };
+
+    struct Point : Base {
+        int x = 0;
+        float y = 0.0f;
+
+        Point() = default;
+        Point(int in_x, float in_y) : x(in_x), y(in_y) {}
+
+        int offset(const int& value) const { return x + value; }
+        void scale(int factor) { x *= factor; }
+        static int twice(int value) { return value * 2; }
+    };
+
+    struct Pair {
+        int first;
+        int second;
+    };
+}
+
+// RTTI as the generator emits it for the canonical unqualified types
+#define FIXTURE_RTTI(TYPE) \
+    template <> \
+    REFLECT_STATIC_CONSTEXPR const RTTITypeInfo& type_info<TYPE>() { \
+        static RTTITypeInfo s = { #TYPE, rtti::hash_type_name(#TYPE), TF_None, 0 }; \
+        return s; \
+    }
+
+namespace zeno { namespace reflect {
+    FIXTURE_RTTI(int)
+    FIXTURE_RTTI(float)
+    FIXTURE_RTTI(fixture::Base)
+    FIXTURE_RTTI(fixture::Point)
+    FIXTURE_RTTI(fixture::Pair)
+}}
+
+using namespace zeno::reflect;
+
+// Rows as TypeRegisterWriter writes them, see src/native_emitter.cpp
+namespace {
+    const IRawMetadata* point_metadata() {
+        static UniquePtr<IRawMetadata> metadata = [] () -> UniquePtr<IRawMetadata> {
+            UniquePtr<IRawMetadata> data = IRawMetadata::create();
+            data->set_value("DisplayName", IMetadataValue::create_string("Point"));
+            return data;
+        }();
+        return metadata.get();
+    }
+
+    const ParamDescriptor fixture_Point_ctor_1_params[] = {
+        { "in_x", &zeno::reflect::type_info<int>, &zeno::reflect::type_info<TTDecay<int>>, nullptr, nullptr },
+        { "in_y", &zeno::reflect::type_info<float>, &zeno::reflect::type_info<TTDecay<float>>, [] () -> Any { return { TInPlaceType<float>{}, 2.5f }; }, nullptr },
+    };
+    const ConstructorDescriptor fixture_Point_ctors[] = {
+        {
+            nullptr, 0,
+            [] (const InvokeArguments& args) -> void* {
+                return new fixture::Point
+                {
+                };
+            },
+            [] (const InvokeArguments& args) -> Any {
+                Any val{};
+                val.emplace<fixture::Point>
+                (
+                );
+                return val;
+            },
+        },
+        {
+            fixture_Point_ctor_1_params, 2,
+            [] (const InvokeArguments& args) -> void* {
+                return new fixture::Point
+                {
+                    any_cast<int>(args[0]),
+                    any_cast<float>(args[1])
+                };
+            },
+            [] (const InvokeArguments& args) -> Any {
+                Any val{};
+                val.emplace<fixture::Point>
+                (
+                    any_cast<int>(args[0]),
+                    any_cast<float>(args[1])
+                );
+                return val;
+            },
+        },
+    };
+
+    const ParamDescriptor fixture_Point_func_0_params[] = {
+        { "value", &zeno::reflect::type_info<const int &>, &zeno::reflect::type_info<TTDecay<const int &>>, nullptr, &thunks::init_value<const int &> },
+    };
+    const ParamDescriptor fixture_Point_func_1_params[] = {
+        { "factor", &zeno::reflect::type_info<int>, &zeno::reflect::type_info<TTDecay<int>>, [] () -> Any { return { TInPlaceType<int>{}, 3 }; }, &thunks::init_value<int> },
+    };
+    const ParamDescriptor fixture_Point_func_2_params[] = {
+        { "value", &zeno::reflect::type_info<int>, &zeno::reflect::type_info<TTDecay<int>>, nullptr, &thunks::init_value<int> },
+    };
+    const FunctionDescriptor fixture_Point_funcs[] = {
+        {
+            "offset", fixture_Point_func_0_params, 1,
+            &get_type<int>, &zeno::reflect::type_info<int>,
+            false, true, false,
+            [] (void* object, const InvokeArguments& args) -> Any {
+                return static_cast<fixture::Point*>(object)->offset(
+                    any_cast<const int &>(args[0])
+                );
+            },
+            nullptr,
+        },
+        {
+            "scale", fixture_Point_func_1_params, 1,
+            &get_type<void>, &zeno::reflect::type_info<void>,
+            false, false, false,
+            [] (void* object, const InvokeArguments& args) -> Any {
+                static_cast<fixture::Point*>(object)->scale(
+                    any_cast<int>(args[0])
+                );
+                return Any::make_null();
+            },
+            &point_metadata,
+        },
+        {
+            "twice", fixture_Point_func_2_params, 1,
+            &get_type<int>, &zeno::reflect::type_info<int>,
+            true, false, false,
+            [] (void* object, const InvokeArguments& args) -> Any {
+                return fixture::Point::twice(
+                    any_cast<int>(args[0])
+                );
+            },
+            nullptr,
+        },
+    };
+
+    const FieldDescriptor fixture_Point_fields[] = {
+        {
+            "x", &get_type<int>,
+            &thunks::field_ptr<&fixture::Point::x>,
+            &thunks::get_field_value<&fixture::Point::x>,
+            &thunks::set_field_value<&fixture::Point::x>,
+            nullptr,
+        },
+        {
+            "y", &get_type<float>,
+            &thunks::field_ptr<&fixture::Point::y>,
+            &thunks::get_field_value<&fixture::Point::y>,
+            &thunks::set_field_value<&fixture::Point::y>,
+            &point_metadata,
+        },
+    };
+
+    const TypeHandleGetter fixture_Point_bases[] = {
+        &get_type<fixture::Base>,
+    };
+    const TypeDescriptor fixture_Point_descriptor {
+        &zeno::reflect::type_info<fixture::Point>,
+        &thunks::object_ptr<fixture::Point>,
+        fixture_Point_ctors, 2,
+        fixture_Point_funcs, 3,
+        fixture_Point_fields, 2,
+        fixture_Point_bases, 1,
+        &point_metadata,
+    };
+
+    const ParamDescriptor fixture_Pair_ctor_0_params[] = {
+        { "first", &zeno::reflect::type_info<int>, &zeno::reflect::type_info<TTDecay<int>>, nullptr, nullptr },
+        { "second", &zeno::reflect::type_info<int>, &zeno::reflect::type_info<TTDecay<int>>, nullptr, nullptr },
+    };
+    const ConstructorDescriptor fixture_Pair_ctors[] = {
+        {
+            fixture_Pair_ctor_0_params, 2,
+            [] (const InvokeArguments& args) -> void* {
+                return new fixture::Pair
+                {
+                    any_cast<int>(args[0]),
+                    any_cast<int>(args[1])
+                };
+            },
+            [] (const InvokeArguments& args) -> Any {
+                Any val{};
+                val.emplace<fixture::Pair>
+                (
+                    fixture::Pair {
+                    any_cast<int>(args[0]),
+                    any_cast<int>(args[1])
+                    }
+                );
+                return val;
+            },
+        },
+    };
+    // A type with no functions, fields, bases or metadata has null tables
+    const TypeDescriptor fixture_Pair_descriptor {
+        &zeno::reflect::type_info<fixture::Pair>,
+        &thunks::object_ptr<fixture::Pair>,
+        fixture_Pair_ctors, 1,
+        nullptr, 0,
+        nullptr, 0,
+        nullptr, 0,
+        nullptr,
+    };
+
+    TypeBase* register_type(const char* qualified_name, const TypeDescriptor& descriptor) {
+        ReflectedTypeInfo info {};
+        info.prefix = "fixture";
+        info.qualified_name = qualified_name;
+        info.canonical_typename = qualified_name;
+        TypeBase* type = new TableType(info, descriptor);
+        (ReflectionRegistry::get())->add(type);
+        return type;
+    }
+
+    bool has_display_name(const IRawMetadata* metadata) {
+        const IMetadataValue* value = nullptr != metadata ? metadata->get_value("DisplayName") : nullptr;
+        return nullptr != value && value->is_string() && std::strcmp(value->as_string(), "Point") == 0;
+    }
+}
+
+int main() {
+    TypeBase* point_type = register_type("fixture::Point", fixture_Point_descriptor);
+    TypeBase* pair_type = register_type("fixture::Pair", fixture_Pair_descriptor);
+
+    // Registered types are found through their RTTI
+    REFLECT_TEST_CHECK(get_type<fixture::Point>().get_reflected_type_or_null() == point_type);
+    REFLECT_TEST_CHECK(point_type->type_hash() == type_info<fixture::Point>().hash_code());
+    REFLECT_TEST_CHECK(has_display_name(point_type->get_metadata()));
+    REFLECT_TEST_CHECK(point_type->get_base_classes().size() == 1);
+    REFLECT_TEST_CHECK(point_type->get_base_classes()[0] == get_type<fixture::Base>());
+
+    // Constructors
+    const ArrayList<ITypeConstructor*>& ctors = point_type->get_constructors();
+    REFLECT_TEST_CHECK(ctors.size() == 2);
+    REFLECT_TEST_CHECK(ctors[0]->get_params().size() == 0);
+    REFLECT_TEST_CHECK(ctors[1]->get_params().size() == 2);
+    REFLECT_TEST_CHECK(ctors[1]->get_params()[1] == type_info<float>());
+    REFLECT_TEST_CHECK_EQ_STR(ctors[1]->get_params_name()[0].c_str(), "in_x");
+    REFLECT_TEST_CHECK(ctors[1]->get_param_default_value(0).has_value() == false);
+    REFLECT_TEST_CHECK(any_cast<float>(ctors[1]->get_param_default_value(1)) == 2.5f);
+
+    Any point = ctors[1]->create_instance({ Any(3), Any(1.5f) });
+    REFLECT_TEST_CHECK(point.type() == type_info<fixture::Point>());
+    REFLECT_TEST_CHECK(any_cast<fixture::Point&>(point).x == 3);
+    REFLECT_TEST_CHECK(any_cast<fixture::Point&>(point).y == 1.5f);
+    fixture::Point* raw_point = static_cast<fixture::Point*>(ctors[0]->new_instance({}));
+    REFLECT_TEST_CHECK(nullptr != raw_point && raw_point->x == 0);
+    delete raw_point;
+    // Arguments which can't be converted don't reach the thunks
+    REFLECT_TEST_CHECK(nullptr == ctors[1]->new_instance({ Any(3) }));
+
+    // Fields
+    const ArrayList<IMemberField*>& fields = point_type->get_member_fields();
+    REFLECT_TEST_CHECK(fields.size() == 2);
+    REFLECT_TEST_CHECK(fields[0]->get_field_type() == get_type<int>());
+    REFLECT_TEST_CHECK(nullptr == fields[0]->get_metadata());
+    REFLECT_TEST_CHECK(has_display_name(fields[1]->get_metadata()));
+    REFLECT_TEST_CHECK(fields[0]->get_field_ptr(point) == &any_cast<fixture::Point&>(point).x);
+    REFLECT_TEST_CHECK(any_cast<int>(fields[0]->get_field_value(&any_cast<fixture::Point&>(point))) == 3);
+    fields[1]->set_field_value(&any_cast<fixture::Point&>(point), Any(4.0f));
+    REFLECT_TEST_CHECK(any_cast<fixture::Point&>(point).y == 4.0f);
+
+    // Member functions
+    const ArrayList<IMemberFunction*>& funcs = point_type->get_member_functions();
+    REFLECT_TEST_CHECK(funcs.size() == 3);
+    REFLECT_TEST_CHECK(funcs[0]->is_const() && !funcs[0]->is_static());
+    REFLECT_TEST_CHECK(funcs[0]->get_return_type() == get_type<int>());
+    REFLECT_TEST_CHECK(any_cast<int>(funcs[0]->invoke(point, ArrayList<Any>{ Any(10) })) == 13);
+    REFLECT_TEST_CHECK(any_cast<int>(funcs[1]->init_param_default_value(0)) == 0);
+    REFLECT_TEST_CHECK(any_cast<int>(funcs[1]->get_param_default_value(0)) == 3);
+    REFLECT_TEST_CHECK(funcs[1]->invoke(point, ArrayList<Any>{ Any(2) }).has_value() == false);
+    REFLECT_TEST_CHECK(any_cast<fixture::Point&>(point).x == 6);
+    REFLECT_TEST_CHECK(has_display_name(funcs[1]->get_metadata()));
+    REFLECT_TEST_CHECK(funcs[2]->is_static());
+    REFLECT_TEST_CHECK(any_cast<int>(funcs[2]->invoke_static(ArrayList<Any>{ Any(21) })) == 42);
+    REFLECT_TEST_CHECK(any_cast<int>(funcs[2]->invoke(Any(), ArrayList<Any>{ Any(4) })) == 8);
+    // A member function needs an object of its type
+    REFLECT_TEST_CHECK(funcs[0]->invoke(Any(1), ArrayList<Any>{ Any(10) }).has_value() == false);
+    REFLECT_TEST_CHECK(funcs[0]->invoke_static(ArrayList<Any>{ Any(10) }).has_value() == false);
+
+    // Aggregate initialization and empty tables
+    REFLECT_TEST_CHECK(pair_type->get_member_functions().size() == 0);
+    REFLECT_TEST_CHECK(pair_type->get_member_fields().size() == 0);
+    REFLECT_TEST_CHECK(pair_type->get_base_classes().size() == 0);
+    REFLECT_TEST_CHECK(nullptr == pair_type->get_metadata());
+    Any pair = pair_type->get_constructors()[0]->create_instance({ Any(1), Any(2) });
+    REFLECT_TEST_CHECK(any_cast<fixture::Pair&>(pair).first == 1 && any_cast<fixture::Pair&>(pair).second == 2);
+
+    return REFLECT_TEST_RESULT();
+}
@@ -0,0 +1,147 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "model.hpp"
+#include "native_emitter.hpp"
+#include "template/template_literal"
+#include "test_common.hpp"
+
+using namespace zeno::reflect;
+
+namespace {
+    ReflectedParam make_param(const char* name, const char* type, const char* default_arg = nullptr) {
+        ReflectedParam param;
+        param.name = name;
+        param.type = type;
+        param.has_default_arg = default_arg != nullptr;
+        param.default_arg = default_arg ? default_arg : "";
+        return param;
+    }
+
+    /// `variant` picks which optional parts the type has, so every branch of the template is rendered
+    ReflectedType make_type(const std::string& name, size_t variant) {
+        ReflectedType type;
+        type.normal_name = "fixture_" + name;
+        type.qualified_name = "fixture::" + name;
+        type.canonical_typename = "fixture::" + name;
+        type.canonical_typename_no_prefix = "fixture::" + name;
+        if (variant == 0) {
+            return type;
+        }
+        type.ctors.push_back(ReflectedConstructor { false, {} });
+        type.ctors.push_back(ReflectedConstructor { variant % 2 == 0, { make_param("a", "int"), make_param("b", "float", "1.0f") } });
+
+        ReflectedFunction getter;
+        getter.name = "get";
+        getter.ret = "int";
+        getter.is_const = true;
+        getter.is_noexcept = variant > 2;
+        type.funcs.push_back(getter);
+        ReflectedFunction setter;
+        setter.name = "set";
+        setter.ret = "void";
+        setter.params = { make_param("value", "const int &"), make_param("notify", "bool", "true") };
+        setter.metadata = variant > 1 ? "&set_metadata" : "";
+        type.funcs.push_back(setter);
+        ReflectedFunction make;
+        make.name = "make";
+        make.ret = "fixture::" + name;
+        make.params = { make_param("seed", "unsigned int") };
+        make.is_static = true;
+        type.funcs.push_back(make);
+
+        type.fields.push_back(ReflectedField { "value", "int", "int", "" });
+        type.fields.push_back(ReflectedField { "label", "std::string", "std::string", variant > 1 ? "&label_metadata" : "" });
+        if (variant > 1) {
+            type.base_classes.push_back(ReflectedBase { "fixture::Base" });
+            type.base_classes.push_back(ReflectedBase { "fixture::Other" });
+            type.metadata = "&type_metadata";
+        }
+        return type;
+    }
+
+    std::string render(const char* text, const inja::json& data) {
+        inja::Environment environment;
+        return environment.render(text, data);
+    }
+
+    std::string render_rtti(const RTTIBlockData& data) {
+        inja::json template_data;
+        template_data["forwordDecl"] = data.forward_decl;
+        template_data["cppType"] = data.cpp_type;
+        template_data["name_normalized"] = data.name_normalized;
+        template_data["name"] = data.name;
+        template_data["dispName"] = data.disp_name;
+        template_data["hash"] = data.hash;
+        template_data["isPointer"] = data.is_pointer;
+        template_data["isRValueRef"] = data.is_rvalue_ref;
+        template_data["isLValueRef"] = data.is_lvalue_ref;
+        template_data["isConst"] = data.is_const;
+        return render(text::RTTI, template_data);
+    }
+
+    std::string write_native(const TypeRegisterData& data) {
+        std::ostringstream out;
+        TypeRegisterWriter(out, data).write();
+        return out.str();
+    }
+
+    RTTIBlockData make_rtti_data(const char* disp_name, bool is_pointer, bool is_const, bool is_rvalue_ref, bool is_lvalue_ref) {
+        RTTIBlockData data;
+        data.forward_decl = "namespace fixture { struct Shape; }";
+        data.cpp_type = "fixture::Shape";
+        data.name_normalized = "fixture_Shape";
+        data.name = "fixture::Shape";
+        data.disp_name = disp_name;
+        data.hash = 12345678901234567890ULL;
+        data.is_pointer = is_pointer;
+        data.is_const = is_const;
+        data.is_rvalue_ref = is_rvalue_ref;
+        data.is_lvalue_ref = is_lvalue_ref;
+        return data;
+    }
+}
+
+int main() {
+    // Every flag alone and together, with and without a display name
+    for (const char* disp_name : { "", "Shape" }) {
+        for (unsigned flags = 0; flags < 16; ++flags) {
+            const RTTIBlockData data = make_rtti_data(disp_name, flags & 1, flags & 2, flags & 4, flags & 8);
+            REFLECT_TEST_CHECK_EQ_STR(emit_rtti_block_native(data), render_rtti(data));
+        }
+    }
+
+    {
+        inja::json template_data;
+        template_data["cppType"] = "fixture::Shape *";
+        template_data["dispName"] = "ShapePtr";
+        template_data["hash"] = 12345678901234567890ULL;
+        REFLECT_TEST_CHECK_EQ_STR(emit_type_name_block_native("fixture::Shape *", "ShapePtr", 12345678901234567890ULL), render(text::TYPE_NAME, template_data));
+    }
+
+    const std::string rtti_block = emit_rtti_block_native(make_rtti_data("Shape", false, false, false, false));
+    for (const char* template_include : { "", "#include \"fixture/templates.h\"" }) {
+        inja::json template_data;
+        template_data["rttiBlock"] = rtti_block;
+        template_data["template_include"] = template_include;
+        REFLECT_TEST_CHECK_EQ_STR(emit_generated_template_header_native(rtti_block, template_include), render(text::GENERATED_TEMPLATE_HEADER_TEMPLATE, template_data));
+    }
+
+    std::ifstream file(REFLECT_TEST_TEMPLATE_DIR "/reflected_type_register.inja");
+    std::stringstream register_template;
+    register_template << file.rdbuf();
+    REFLECT_TEST_CHECK(!register_template.str().empty());
+
+    TypeRegisterData data;
+    data.prefix = "fixture";
+    REFLECT_TEST_CHECK_EQ_STR(write_native(data), render(register_template.str().c_str(), inja::json(data)));
+
+    data.headers = { "fixture/a.h", "fixture/b.h" };
+    for (size_t i = 0; i < 4; ++i) {
+        data.types.push_back(make_type("Type" + std::to_string(i), i));
+    }
+    REFLECT_TEST_CHECK_EQ_STR(write_native(data), render(register_template.str().c_str(), inja::json(data)));
+
+    return REFLECT_TEST_RESULT();
+}
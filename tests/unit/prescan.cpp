@@ -0,0 +1,68 @@
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include "prescan.hpp"
+#include "test_common.hpp"
+
+using namespace zeno::reflect;
+
+namespace {
+    const std::filesystem::path DATA_DIR = REFLECT_TEST_DATA_DIR "/prescan";
+
+    std::string data_path(const char* name) {
+        return (DATA_DIR / name).lexically_normal().generic_string();
+    }
+
+    bool scan(ReflectionMarkerPrescan& prescan, const char* name, std::set<std::string>* out_files = nullptr) {
+        const std::string path = data_path(name);
+        std::ifstream file(path);
+        std::stringstream source;
+        source << file.rdbuf();
+        std::set<std::string> files;
+        const bool result = prescan.has_reflection_markers(path, source.str(), files);
+        if (out_files) {
+            *out_files = std::move(files);
+        }
+        return result;
+    }
+}
+
+int main() {
+    ReflectionMarkerPrescan prescan({ data_path("include"), REFLECT_TEST_LIBREFLECT_INCLUDE_DIR });
+
+    REFLECT_TEST_CHECK(scan(prescan, "annotated.h"));
+
+    // A header without markers of its own that includes annotated headers
+    std::set<std::string> aggregator_files;
+    REFLECT_TEST_CHECK(scan(prescan, "aggregator.h", &aggregator_files));
+    REFLECT_TEST_CHECK(aggregator_files.contains(data_path("annotated.h")));
+    REFLECT_TEST_CHECK(scan(prescan, "include/lib/nested_aggregator.h"));
+
+    // Includes with angle brackets are resolved in the include dirs only, not next to the including file
+    std::set<std::string> angle_aggregator_files;
+    REFLECT_TEST_CHECK(scan(prescan, "angle_aggregator.h", &angle_aggregator_files));
+    REFLECT_TEST_CHECK(angle_aggregator_files.contains(data_path("include/aggregator.h")));
+    REFLECT_TEST_CHECK(!angle_aggregator_files.contains(data_path("aggregator.h")));
+
+    // A manual registration is the only input of a header included with angle brackets
+    std::set<std::string> angle_registration_files;
+    REFLECT_TEST_CHECK(scan(prescan, "angle_registration.h", &angle_registration_files));
+    REFLECT_TEST_CHECK(angle_registration_files.contains(data_path("include/manual_registration.h")));
+    REFLECT_TEST_CHECK(scan(prescan, "include/manual_registration.h"));
+
+    // Skipped headers depend on everything they include, and macros defined by libreflect don't count
+    std::set<std::string> plain_files;
+    REFLECT_TEST_CHECK(!scan(prescan, "plain.h", &plain_files));
+    REFLECT_TEST_CHECK(plain_files.contains(data_path("plain.h")));
+    REFLECT_TEST_CHECK(plain_files.contains(data_path("plain_dep.h")));
+    REFLECT_TEST_CHECK(plain_files.size() > 3);
+
+    // Macros defined with a marker are markers themselves
+    REFLECT_TEST_CHECK(scan(prescan, "uses_macro.h"));
+    REFLECT_TEST_CHECK(!scan(prescan, "only_macros.h"));
+    REFLECT_TEST_CHECK(!scan(prescan, "macros.h"));
+
+    return REFLECT_TEST_RESULT();
+}
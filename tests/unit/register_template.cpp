@@ -0,0 +1,143 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "model.hpp"
+#include "register_template.hpp"
+#include "test_common.hpp"
+
+using namespace zeno::reflect;
+
+namespace {
+    ReflectedParam make_param(const char* name, const char* type, const char* default_arg = nullptr) {
+        ReflectedParam param;
+        param.name = name;
+        param.type = type;
+        param.has_default_arg = default_arg != nullptr;
+        param.default_arg = default_arg ? default_arg : "";
+        return param;
+    }
+
+    ReflectedType make_type(const std::string& name, size_t members) {
+        ReflectedType type;
+        type.normal_name = "fixture_" + name;
+        type.qualified_name = "fixture::" + name;
+        type.canonical_typename = "fixture::" + name;
+        type.canonical_typename_no_prefix = "fixture::" + name;
+        for (size_t i = 0; i < members; ++i) {
+            const std::string index = std::to_string(i);
+            type.ctors.push_back(ReflectedConstructor { i % 2 == 0, { make_param("a", "int"), make_param("b", "float", "1.0f") } });
+            ReflectedFunction func;
+            func.name = "get" + index;
+            func.ret = i % 2 == 0 ? "void" : "int";
+            func.params = { make_param("x", "const int &") };
+            func.is_const = true;
+            type.funcs.push_back(func);
+            type.fields.push_back(ReflectedField { "field" + index, "int", "int", i == 0 ? "&field_metadata" : "" });
+            type.base_classes.push_back(ReflectedBase { "fixture::Base" + index });
+        }
+        type.metadata = members > 1 ? "&type_metadata" : "";
+        return type;
+    }
+
+    TypeRegisterData make_data() {
+        TypeRegisterData data;
+        data.prefix = "fixture";
+        data.headers = { "fixture/a.h", "fixture/b.h" };
+        for (size_t i = 0; i < 6; ++i) {
+            data.types.push_back(make_type("Type" + std::to_string(i), i % 4));
+        }
+        return data;
+    }
+
+    /// The parts rendered the way the emitter does, the sections on threads that each have their own environment
+    std::string render_split(const SplitRegisterTemplate& split, const TypeRegisterData& data) {
+        inja::json shared_json = inja::json(data);
+        shared_json.erase("types");
+
+        std::vector<std::string> sections(data.types.size());
+        std::vector<std::thread> workers;
+        for (size_t worker = 0; worker < 3; ++worker) {
+            workers.emplace_back([&, worker] {
+                inja::Environment environment;
+                inja::json worker_json = shared_json;
+                for (size_t index = worker; index < data.types.size(); index += 3) {
+                    worker_json["types"] = inja::json::array({ inja::json(data.types[index]) });
+                    sections[index] = environment.render(split.type_section, worker_json);
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        inja::Environment environment;
+        std::string result = environment.render(split.prelude, shared_json);
+        for (const std::string& section : sections) {
+            result += section;
+        }
+        return result + environment.render(split.epilogue, shared_json);
+    }
+
+    /// Split `text`, false if it can't be, otherwise check that the split render equals the whole one
+    bool check_split(const std::string& text, const TypeRegisterData& data) {
+        inja::Environment environment;
+        const inja::Template tmpl = environment.parse(text);
+        const std::optional<SplitRegisterTemplate> split = split_register_template(tmpl);
+        if (!split.has_value()) {
+            return false;
+        }
+        REFLECT_TEST_CHECK_EQ_STR(render_split(split.value(), data), environment.render(tmpl, inja::json(data)));
+        return true;
+    }
+}
+
+int main() {
+    const TypeRegisterData data = make_data();
+
+    // The shipped register template
+    std::ifstream file(REFLECT_TEST_TEMPLATE_DIR "/reflected_type_register.inja");
+    std::stringstream shipped;
+    shipped << file.rdbuf();
+    REFLECT_TEST_CHECK(!shipped.str().empty());
+    REFLECT_TEST_CHECK(check_split(shipped.str(), data));
+
+    // generator.inja_stream_vs_whole_render relies on this to render the shipped template whole
+    REFLECT_TEST_CHECK(!check_split(shipped.str() + "{% set whole_render = true %}", data));
+
+    TypeRegisterData no_types = data;
+    no_types.types.clear();
+    REFLECT_TEST_CHECK(check_split(shipped.str(), no_types));
+
+    // Comments, whitespace control and `types` in plain text don't confuse the split
+    REFLECT_TEST_CHECK(check_split(
+        "{# for t in types #}// all types of {{ prefix }}\n"
+        "{%- for t in types -%}\n  [{{ t.qualified_name }}]\n{%- endfor -%}\n"
+        "// end of types\n", data));
+    REFLECT_TEST_CHECK(check_split(
+        "{% for t in types %}{{ t.normal_name }}:{% for f in t.fields %}{{ loop.index }}={{ f.name }}{% if not loop.is_last %},{% endif %}{% endfor %}\n{% endfor %}", data));
+    REFLECT_TEST_CHECK(check_split(
+        "## for header in headers\n#include \"{{ header }}\"\n## endfor\n"
+        "## for t in types\n{{ t.qualified_name }} {{ prefix }}\n## endfor\n"
+        "## for header in headers\n// {{ header }}\n## endfor\n", data));
+    // A nested loop may reuse the name of a variable from the prelude, it reads its own one
+    REFLECT_TEST_CHECK(check_split(
+        "{% for x in headers %}{{ x }}{% endfor %}\n{% for t in types %}{% for x in t.fields %}{{ x.name }}{% endfor %}\n{% endfor %}", data));
+
+    // Renders that depend on more than a single type
+    REFLECT_TEST_CHECK(!check_split("{% for t in types %}{{ loop.index }} {{ t.normal_name }}\n{% endfor %}", data));
+    REFLECT_TEST_CHECK(!check_split("{% for t in types %}{% for f in t.fields %}{{ loop.parent.index }}{% endfor %}{% endfor %}", data));
+    REFLECT_TEST_CHECK(!check_split("{% for t in types %}{{ t.normal_name }}{% endfor %}{{ length(types) }}", data));
+    REFLECT_TEST_CHECK(!check_split("{% for t in types %}{{ t.normal_name }}{% endfor %}{% if exists(\"types\") %}x{% endif %}", data));
+    REFLECT_TEST_CHECK(!check_split("{% for t in types %}{{ t.normal_name }}{% endfor %}{% for t in types %}{{ t.qualified_name }}{% endfor %}", data));
+    REFLECT_TEST_CHECK(!check_split("{% if true %}{% for t in types %}{{ t.normal_name }}{% endfor %}{% endif %}", data));
+    REFLECT_TEST_CHECK(!check_split("{% set count = 0 %}{% for t in types %}{{ t.normal_name }}{% endfor %}", data));
+    // Loop state left over from an earlier part
+    REFLECT_TEST_CHECK(!check_split("{% for t in types %}{{ t.normal_name }}{% endfor %}{{ t }}", data));
+    REFLECT_TEST_CHECK(!check_split("{% for t in types %}{% for f in t.fields %}{% endfor %}{% endfor %}{{ f }}", data));
+    REFLECT_TEST_CHECK(!check_split("{% for t in types %}{{ t.normal_name }}{% endfor %}{{ loop.index }}", data));
+    REFLECT_TEST_CHECK(!check_split("{% for h in headers %}{% endfor %}{% for t in types %}{{ h }}{% endfor %}", data));
+
+    return REFLECT_TEST_RESULT();
+}
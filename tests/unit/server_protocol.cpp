@@ -0,0 +1,97 @@
+#include <chrono>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "server_protocol.hpp"
+#include "test_common.hpp"
+
+using namespace zeno::reflect;
+
+namespace {
+    struct SocketPair {
+        int fds[2] = { -1, -1 };
+
+        SocketPair() {
+            ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+        }
+
+        ~SocketPair() {
+            ::close(fds[0]);
+            ::close(fds[1]);
+        }
+    };
+
+    constexpr ServerMessageLimits TEST_LIMITS { 4, 16 };
+
+    void write_u64(int fd, uint64_t value) {
+        write_all(fd, &value, sizeof(value));
+    }
+}
+
+int main() {
+    // Round trip
+    {
+        SocketPair pair;
+        const std::vector<std::string> sent { "zeno-reflect-generator/1:1:2", "/work", "", "--jobs=4" };
+        REFLECT_TEST_CHECK(send_strings(pair.fds[0], sent));
+        const auto received = receive_strings(pair.fds[1], SERVER_REQUEST_LIMITS);
+        REFLECT_TEST_CHECK(received.has_value() && *received == sent);
+    }
+
+    // Too many strings is rejected before reading them
+    {
+        SocketPair pair;
+        REFLECT_TEST_CHECK(send_strings(pair.fds[0], { "a", "b", "c", "d", "e" }));
+        REFLECT_TEST_CHECK(!receive_strings(pair.fds[1], TEST_LIMITS).has_value());
+    }
+
+    // A huge length is rejected without allocating it
+    {
+        SocketPair pair;
+        write_u64(pair.fds[0], 1);
+        write_u64(pair.fds[0], uint64_t(1) << 62);
+        REFLECT_TEST_CHECK(!receive_strings(pair.fds[1], SERVER_REQUEST_LIMITS).has_value());
+    }
+    {
+        SocketPair pair;
+        REFLECT_TEST_CHECK(send_strings(pair.fds[0], { std::string(17, 'x') }));
+        REFLECT_TEST_CHECK(!receive_strings(pair.fds[1], TEST_LIMITS).has_value());
+    }
+    {
+        SocketPair pair;
+        write_u64(pair.fds[0], uint64_t(1) << 40);
+        REFLECT_TEST_CHECK(!receive_strings(pair.fds[1], SERVER_REQUEST_LIMITS).has_value());
+    }
+
+    // A truncated message fails once the peer is gone
+    {
+        SocketPair pair;
+        write_u64(pair.fds[0], 2);
+        write_u64(pair.fds[0], 8);
+        write_all(pair.fds[0], "abc", 3);
+        ::shutdown(pair.fds[0], SHUT_WR);
+        REFLECT_TEST_CHECK(!receive_strings(pair.fds[1], SERVER_REQUEST_LIMITS).has_value());
+    }
+
+    // A silent peer times out
+    {
+        SocketPair pair;
+        REFLECT_TEST_CHECK(set_receive_timeout(pair.fds[1], 200));
+        const auto begin = std::chrono::steady_clock::now();
+        REFLECT_TEST_CHECK(!receive_strings(pair.fds[1], SERVER_REQUEST_LIMITS).has_value());
+        REFLECT_TEST_CHECK(std::chrono::steady_clock::now() - begin < std::chrono::seconds(5));
+    }
+
+    // Handshakes of other builds are recognized, garbage is not
+    REFLECT_TEST_CHECK(is_server_handshake(get_server_handshake()));
+    REFLECT_TEST_CHECK(is_server_handshake("zeno-reflect-generator/1:123:456"));
+    REFLECT_TEST_CHECK(is_server_handshake("zeno-reflect-generator/2:stamp"));
+    REFLECT_TEST_CHECK(!is_server_handshake(""));
+    REFLECT_TEST_CHECK(!is_server_handshake("GET / HTTP/1.1"));
+    REFLECT_TEST_CHECK(!is_server_handshake("zeno-reflect-generator/1"));
+    REFLECT_TEST_CHECK(!is_server_handshake("zeno-reflect-generator/1:"));
+    REFLECT_TEST_CHECK(!is_server_handshake("zeno-reflect-generator/:stamp"));
+
+    return REFLECT_TEST_RESULT();
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// Tests are plain executables, a failed check prints where it failed and makes the test exit with a non-zero code
+inline int g_reflect_test_failures = 0;
+
+#define REFLECT_TEST_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++g_reflect_test_failures; \
+        } \
+    } while (false)
+
+#define REFLECT_TEST_CHECK_EQ_STR(actual, expected) \
+    do { \
+        const std::string reflect_test_actual = (actual); \
+        const std::string reflect_test_expected = (expected); \
+        if (reflect_test_actual != reflect_test_expected) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n  actual:   \"%s\"\n  expected: \"%s\"\n", __FILE__, __LINE__, #actual, reflect_test_actual.c_str(), reflect_test_expected.c_str()); \
+            ++g_reflect_test_failures; \
+        } \
+    } while (false)
+
+#define REFLECT_TEST_RESULT() (g_reflect_test_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE)
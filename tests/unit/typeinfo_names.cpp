@@ -0,0 +1,76 @@
+#include <string>
+#include <cstdint>
+#include "reflect/core.hpp"
+#include "reflect/typeinfo.hpp"
+#include "test_common.hpp"
+
+// What the generator emits for the unqualified types, the hash is FNV-1a of clang's spelling
+namespace zeno { namespace reflect {
+    template <>
+    REFLECT_STATIC_CONSTEXPR const RTTITypeInfo& type_info<int>() {
+        static RTTITypeInfo s = { "int", 3143511548502526014ULL, TF_None, 0 };
+        return s;
+    }
+
+    template <>
+    REFLECT_STATIC_CONSTEXPR const RTTITypeInfo& type_info<bool>() {
+        static RTTITypeInfo s = { "bool", 15698046148323980066ULL, TF_None, 0 };
+        return s;
+    }
+}}
+
+using namespace zeno::reflect;
+
+namespace {
+    uint64_t fnv1a(const char* str) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (; *str; ++str) {
+            hash = (hash ^ static_cast<unsigned char>(*str)) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    void check_type(const char* expected_name, const char* hashed_spelling) {
+        const RTTITypeInfo& info = type_info<T>();
+        REFLECT_TEST_CHECK_EQ_STR(info.name(), expected_name);
+        REFLECT_TEST_CHECK(info.hash_code() == static_cast<size_t>(fnv1a(hashed_spelling)));
+        REFLECT_TEST_CHECK(info.hash_code() == rtti::hash_type_name(expected_name));
+    }
+}
+
+int main() {
+    REFLECT_TEST_CHECK(type_info<int>().hash_code() == static_cast<size_t>(fnv1a("int")));
+    REFLECT_TEST_CHECK(type_info<bool>().hash_code() == static_cast<size_t>(fnv1a("_Bool")));
+
+    // Names as clang prints them
+    check_type<const int>("const int", "const int");
+    check_type<int&>("int &", "int &");
+    check_type<int&&>("int &&", "int &&");
+    check_type<const int&>("const int &", "const int &");
+    check_type<int*>("int *", "int *");
+    check_type<int**>("int **", "int **");
+    check_type<const int*>("const int *", "const int *");
+    check_type<const int*&>("const int *&", "const int *&");
+    check_type<int* const>("int *const", "int *const");
+    check_type<int* const*>("int *const *", "int *const *");
+    check_type<const int* const&>("const int *const &", "const int *const &");
+    check_type<int**&&>("int **&&", "int **&&");
+
+    // The generator hashes "_Bool" but names it "bool"
+    check_type<const bool&>("const bool &", "const _Bool &");
+    check_type<bool*>("bool *", "_Bool *");
+
+    // Explicit specializations use the same scheme as derived ones
+    REFLECT_TEST_CHECK(type_info<const char*>().hash_code() == rtti::hash_type_name(type_info<const char*>().name()));
+    REFLECT_TEST_CHECK(type_info<void*>().hash_code() == rtti::hash_type_name(type_info<void*>().name()));
+    REFLECT_TEST_CHECK(type_info<const void*>().hash_code() == rtti::hash_type_name(type_info<const void*>().name()));
+
+    // Flags and decayed hash
+    REFLECT_TEST_CHECK(type_info<const int&>().flags() == (TF_IsConst | TF_IsLValueRef));
+    REFLECT_TEST_CHECK(type_info<int* const>().flags() == (TF_IsPointer | TF_IsConst));
+    REFLECT_TEST_CHECK(type_info<int&&>().get_decayed_hash() == type_info<int>().hash_code());
+    REFLECT_TEST_CHECK(type_info<int**>().get_decayed_hash() == type_info<int*>().hash_code());
+
+    return REFLECT_TEST_RESULT();
+}